@@ -0,0 +1,534 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <roonmath.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "../src/packer.h"
+#include "../src/roonium_memory.h"
+#include "../src/roonium_mesh.h"
+#include "../src/roonium_sort.h"
+
+/* stb_image implementation? */
+unsigned char *stbi_load_from_memory(unsigned char const *buffer, int len, int *x, int *y, int *channels_in_file, int desired_channels);
+void stbi_image_free(void *retval_from_stbi_load);
+
+#ifndef UNUSED
+#define UNUSED(_v) (void)(_v)
+#endif
+
+#define ROONIUM_BENCH_WARMUP 3
+#define ROONIUM_BENCH_RUNS 15
+#define ROONIUM_BENCH_CASES_MAX 16
+
+/* Visible items of the swarm scene, about. */
+#define ROONIUM_BENCH_SORT_COUNT 100000
+/* Every timed run is at least this long, iterations are doubled until so. */
+#define ROONIUM_BENCH_RUN_TIME 0.02
+#define ROONIUM_BENCH_ITERATIONS_MAX (1UL << 28)
+/* Default slowdown, in percent of the baseline median, that fails the run. */
+#define ROONIUM_BENCH_THRESHOLD 25.0
+#define ROONIUM_BENCH_ARENA_SIZE (32 * 1024 * 1024)
+
+typedef void (*roonium_bench_function)(void *data, unsigned long iterations);
+
+/* One measured function. _bytes is per iteration, 0 if not a throughput. */
+typedef struct roonium_bench_case
+{
+  const char *name;
+  roonium_bench_function function;
+  void *data;
+  double bytes;
+} roonium_bench_case;
+
+typedef struct roonium_bench_result
+{
+  unsigned long iterations;
+  double median_ns;
+  double mad_ns;
+  double mb_per_s;
+} roonium_bench_result;
+
+/* Shared by all cases. */
+typedef struct roonium_bench_context
+{
+  struct roonium_arena arena;
+  struct buffer jpg;
+  struct buffer png;
+  struct buffer packer_input;
+  FILE *packer_output;
+} roonium_bench_context;
+
+/* Results land here so the optimizer keeps the work. */
+static volatile float roonium_bench_sink = 0.0f;
+
+static double roonium_bench__time(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER counter, frequency;
+
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+#endif
+}
+
+static int roonium_bench__compare(
+    const void *_a,
+    const void *_b)
+{
+  const double a = *(const double *)_a;
+  const double b = *(const double *)_b;
+
+  return (a > b) - (a < b);
+}
+
+static double roonium_bench__median(
+    double *_values,
+    const size_t _count)
+{
+  qsort(_values, _count, sizeof(*_values), roonium_bench__compare);
+
+  if (_count % 2)
+    return _values[_count / 2];
+
+  return (_values[_count / 2 - 1] + _values[_count / 2]) / 2.0;
+}
+
+static double roonium_bench__run_once(
+    const struct roonium_bench_case *_case,
+    const unsigned long _iterations)
+{
+  const double start = roonium_bench__time();
+
+  _case->function(_case->data, _iterations);
+
+  return roonium_bench__time() - start;
+}
+
+/* Warms up while growing the iteration count, then times
+ * ROONIUM_BENCH_RUNS runs and reduces them to median and MAD. */
+static struct roonium_bench_result roonium_bench__run(
+    const struct roonium_bench_case *_case)
+{
+  struct roonium_bench_result result;
+  double samples[ROONIUM_BENCH_RUNS];
+  double deviations[ROONIUM_BENCH_RUNS];
+  unsigned long iterations = 1;
+  size_t i = 0;
+
+  while (roonium_bench__run_once(_case, iterations) < ROONIUM_BENCH_RUN_TIME &&
+         iterations < ROONIUM_BENCH_ITERATIONS_MAX)
+  {
+    iterations *= 2;
+  }
+
+  while (i < ROONIUM_BENCH_WARMUP)
+  {
+    roonium_bench__run_once(_case, iterations);
+    i++;
+  }
+
+  i = 0;
+  while (i < ROONIUM_BENCH_RUNS)
+  {
+    samples[i] = roonium_bench__run_once(_case, iterations) * 1e9 /
+                 (double)iterations;
+    i++;
+  }
+
+  memset(&result, 0, sizeof(result));
+  result.iterations = iterations;
+  result.median_ns = roonium_bench__median(samples, ROONIUM_BENCH_RUNS);
+
+  i = 0;
+  while (i < ROONIUM_BENCH_RUNS)
+  {
+    deviations[i] = fabs(samples[i] - result.median_ns);
+    i++;
+  }
+  result.mad_ns = roonium_bench__median(deviations, ROONIUM_BENCH_RUNS);
+
+  if (_case->bytes > 0.0 && result.median_ns > 0.0)
+    result.mb_per_s = _case->bytes / (1024.0 * 1024.0) /
+                      (result.median_ns * 1e-9);
+
+  return result;
+}
+
+/* Looks _name up in a file written by this program. Returns 0 if found. */
+static int roonium_bench__find_baseline(
+    const char *_baseline,
+    const char *_name,
+    double *_median_ns,
+    double *_mad_ns)
+{
+  char key[128];
+  const char *entry, *field;
+
+  sprintf(key, "\"name\": \"%.100s\"", _name);
+  entry = strstr(_baseline, key);
+  if (!entry)
+    return 1;
+
+  field = strstr(entry, "\"median_ns\":");
+  if (!field)
+    return 1;
+  *_median_ns = strtod(field + strlen("\"median_ns\":"), NULL);
+
+  field = strstr(entry, "\"mad_ns\":");
+  if (!field)
+    return 1;
+  *_mad_ns = strtod(field + strlen("\"mad_ns\":"), NULL);
+
+  return 0;
+}
+
+/* Cases. */
+static void bench_matrix_multiply(void *_data, unsigned long _iterations)
+{
+  roonium_matrix a, b, result;
+  unsigned long i = 0;
+
+  UNUSED(_data);
+  matrix_perspective(a, (float)DEGTORAD(60.0f), 1.5f, 0.1f, 100.0f);
+  matrix_identity(b);
+  matrix_translate_in_place(b, 1.0f, 2.0f, 3.0f);
+
+  while (i < _iterations)
+  {
+    b[3][0] = (float)i;
+    matrix_multiply(result, a, b);
+    roonium_bench_sink += result[3][0];
+    i++;
+  }
+}
+
+static void bench_matrix_look_at(void *_data, unsigned long _iterations)
+{
+  roonium_matrix result;
+  struct roonium_vector3 eye = {0.0f, 2.0f, 5.0f};
+  const struct roonium_vector3 center = {0.0f, 0.0f, 0.0f};
+  const struct roonium_vector3 up = {0.0f, 1.0f, 0.0f};
+  unsigned long i = 0;
+
+  UNUSED(_data);
+  while (i < _iterations)
+  {
+    eye.x = (float)(i & 255) * 0.01f;
+    matrix_look_at(result, eye, center, up);
+    roonium_bench_sink += result[3][2];
+    i++;
+  }
+}
+
+static void bench_matrix_perspective(void *_data, unsigned long _iterations)
+{
+  roonium_matrix result;
+  unsigned long i = 0;
+
+  UNUSED(_data);
+  while (i < _iterations)
+  {
+    matrix_perspective(
+        result,
+        (float)DEGTORAD(60.0f),
+        1.0f + (float)(i & 255) * 0.01f,
+        0.1f,
+        100.0f);
+    roonium_bench_sink += result[0][0];
+    i++;
+  }
+}
+
+static void bench_vector3_normalize(void *_data, unsigned long _iterations)
+{
+  struct roonium_vector3 v = {1.0f, 2.0f, 3.0f};
+  unsigned long i = 0;
+
+  UNUSED(_data);
+  while (i < _iterations)
+  {
+    v.x = 1.0f + (float)(i & 255);
+    v = vector3_normalize(v);
+    roonium_bench_sink += v.y;
+    i++;
+  }
+}
+
+static void bench_packer(void *_data, unsigned long _iterations)
+{
+  struct roonium_bench_context *context = _data;
+  unsigned long i = 0;
+
+  while (i < _iterations)
+  {
+    rewind(context->packer_output);
+    writePackedArray(
+        context->packer_output,
+        "resources/roon.jpg",
+        context->packer_input);
+    i++;
+  }
+}
+
+/* CPU side of generate_mesh_pyramid. */
+static void bench_mesh_pyramid(void *_data, unsigned long _iterations)
+{
+  struct roonium_bench_context *context = _data;
+  roonium_vertex *vertices;
+  unsigned long i = 0;
+
+  while (i < _iterations)
+  {
+    roonium_arena__reset(&context->arena);
+    vertices = roonium_arena__alloc(
+        &context->arena,
+        ROONIUM_PYRAMID_VERTICES_COUNT * sizeof(struct roonium_vertex));
+    build_pyramid_vertices(vertices, 1.25f, 1.0f, 1.25f);
+    roonium_bench_sink += vertices[0].normals.x;
+    i++;
+  }
+}
+
+/* CPU side of generate_mesh_lod_sphere. */
+static void bench_mesh_lod_sphere(void *_data, unsigned long _iterations)
+{
+  struct roonium_bench_context *context = _data;
+  struct roonium_mesh_data data;
+  unsigned long i = 0;
+
+  while (i < _iterations)
+  {
+    roonium_arena__reset(&context->arena);
+    if (!build_mesh_data_sphere(&data, &context->arena, 0.5f, 0.08f, 64, 128))
+      build_mesh_data_lods(&data, &context->arena, ROONIUM_LOD_LEVELS_MAX);
+    roonium_bench_sink += (float)data.lods_count;
+    i++;
+  }
+}
+
+/* Depth keys of render_queue_sort, from scattered depths. */
+static void bench_sort_radix(void *_data, unsigned long _iterations)
+{
+  struct roonium_bench_context *context = _data;
+  struct roonium_sort_key *keys, *scratch, *sorted;
+  unsigned int seed;
+  unsigned long i = 0;
+  size_t j;
+
+  roonium_arena__reset(&context->arena);
+  keys = roonium_arena__alloc(
+      &context->arena,
+      ROONIUM_BENCH_SORT_COUNT * sizeof(struct roonium_sort_key));
+  scratch = roonium_arena__alloc(
+      &context->arena,
+      ROONIUM_BENCH_SORT_COUNT * sizeof(struct roonium_sort_key));
+  if (!keys || !scratch)
+    return;
+
+  while (i < _iterations)
+  {
+    seed = 12345u;
+    j = 0;
+    while (j < ROONIUM_BENCH_SORT_COUNT)
+    {
+      seed = seed * 1664525u + 1013904223u;
+      keys[j].key = roonium_sort__float_key((float)(seed >> 8) / 65536.0f);
+      keys[j].index = (unsigned int)j;
+      j++;
+    }
+    sorted = roonium_sort__radix(keys, scratch, ROONIUM_BENCH_SORT_COUNT);
+    roonium_bench_sink += (float)sorted[0].index;
+    i++;
+  }
+}
+
+/* Same path as load_texture_from_memory: decode into the scratch arena. */
+static void bench_decode(
+    struct roonium_arena *_arena,
+    const struct buffer _image,
+    const unsigned long _iterations)
+{
+  unsigned char *pixels;
+  int w, h;
+  unsigned long i = 0;
+
+  roonium_memory__bind_scratch(_arena);
+  while (i < _iterations)
+  {
+    roonium_arena__reset(_arena);
+    pixels = stbi_load_from_memory(_image.data, _image.size, &w, &h, 0, 4);
+    if (pixels)
+    {
+      roonium_bench_sink += pixels[0];
+      /* Frees through roonium_memory__free, a heap fallback included. */
+      stbi_image_free(pixels);
+    }
+    i++;
+  }
+  roonium_memory__bind_scratch(NULL);
+}
+
+static void bench_decode_jpg(void *_data, unsigned long _iterations)
+{
+  struct roonium_bench_context *context = _data;
+
+  bench_decode(&context->arena, context->jpg, _iterations);
+}
+
+static void bench_decode_png(void *_data, unsigned long _iterations)
+{
+  struct roonium_bench_context *context = _data;
+
+  bench_decode(&context->arena, context->png, _iterations);
+}
+
+/* Usage: roonium_bench [baseline.json [threshold_percent]]
+ * Prints JSON results to stdout and a summary to stderr. With a baseline,
+ * exits with failure when a median is slower than the baseline by more
+ * than the threshold and by more than three baseline MADs. */
+int main(int _argc, const char **_argv)
+{
+  struct roonium_bench_context context;
+  struct roonium_bench_case cases[ROONIUM_BENCH_CASES_MAX];
+  struct roonium_bench_result result;
+  struct buffer baseline;
+  const char *baseline_text = NULL;
+  char *baseline_copy = NULL;
+  double threshold = ROONIUM_BENCH_THRESHOLD;
+  double baseline_median, baseline_mad, change;
+  size_t cases_count = 0, i = 0, regressions_count = 0;
+
+  memset(&context, 0, sizeof(context));
+  memset(&baseline, 0, sizeof(baseline));
+
+  if (_argc > 1)
+  {
+    baseline = loadFile(_argv[1], "rb");
+    if (!baseline.data)
+    {
+      fprintf(stderr, "[ ERROR ]:\t cannot open baseline! %s\n", _argv[1]);
+      return EXIT_FAILURE;
+    }
+    baseline_copy = malloc(baseline.size + 1);
+    if (!baseline_copy)
+      return EXIT_FAILURE;
+    memcpy(baseline_copy, baseline.data, baseline.size);
+    baseline_copy[baseline.size] = 0;
+    baseline_text = baseline_copy;
+  }
+  if (_argc > 2)
+    threshold = atof(_argv[2]);
+
+  context.jpg = loadFile("resources/roon.jpg", "rb");
+  context.png = loadFile("resources/roon_icon.png", "rb");
+  context.packer_input = context.jpg;
+  context.packer_output = tmpfile();
+
+  if (!context.jpg.data ||
+      !context.png.data ||
+      !context.packer_output ||
+      roonium_arena__init(&context.arena, ROONIUM_BENCH_ARENA_SIZE))
+  {
+    fprintf(stderr, "[ ERROR ]:\t cannot prepare benchmarks! Run from the repository root.\n");
+    return EXIT_FAILURE;
+  }
+
+#define ROONIUM_BENCH_ADD(_name, _function, _bytes) \
+  cases[cases_count].name = _name;                  \
+  cases[cases_count].function = _function;          \
+  cases[cases_count].data = &context;               \
+  cases[cases_count].bytes = _bytes;                \
+  cases_count++
+
+  ROONIUM_BENCH_ADD("roonmath/matrix_multiply", bench_matrix_multiply, 0.0);
+  ROONIUM_BENCH_ADD("roonmath/matrix_look_at", bench_matrix_look_at, 0.0);
+  ROONIUM_BENCH_ADD("roonmath/matrix_perspective", bench_matrix_perspective, 0.0);
+  ROONIUM_BENCH_ADD("roonmath/vector3_normalize", bench_vector3_normalize, 0.0);
+  ROONIUM_BENCH_ADD("packer/roon_jpg", bench_packer, (double)context.packer_input.size);
+  ROONIUM_BENCH_ADD("mesh/pyramid", bench_mesh_pyramid, 0.0);
+  ROONIUM_BENCH_ADD("mesh/lod_sphere", bench_mesh_lod_sphere, 0.0);
+  ROONIUM_BENCH_ADD("image/decode_jpg", bench_decode_jpg, (double)context.jpg.size);
+  ROONIUM_BENCH_ADD("image/decode_png", bench_decode_png, (double)context.png.size);
+  ROONIUM_BENCH_ADD("sort/radix_100k", bench_sort_radix, 0.0);
+
+#undef ROONIUM_BENCH_ADD
+
+  printf("{\n  \"runs\": %d,\n  \"warmup\": %d,\n  \"benchmarks\": [\n",
+         ROONIUM_BENCH_RUNS,
+         ROONIUM_BENCH_WARMUP);
+
+  while (i < cases_count)
+  {
+    result = roonium_bench__run(&cases[i]);
+
+    printf("    {\"name\": \"%s\", \"iterations\": %lu, "
+           "\"median_ns\": %.3f, \"mad_ns\": %.3f, \"mb_per_s\": %.3f}%s\n",
+           cases[i].name,
+           result.iterations,
+           result.median_ns,
+           result.mad_ns,
+           result.mb_per_s,
+           i + 1 < cases_count ? "," : "");
+    fflush(stdout);
+
+    fprintf(stderr, "%-30s %14.1f ns +- %-10.1f", cases[i].name, result.median_ns, result.mad_ns);
+    if (result.mb_per_s > 0.0)
+      fprintf(stderr, " %8.1f MB/s", result.mb_per_s);
+
+    if (baseline_text &&
+        !roonium_bench__find_baseline(baseline_text, cases[i].name, &baseline_median, &baseline_mad) &&
+        baseline_median > 0.0)
+    {
+      change = (result.median_ns / baseline_median - 1.0) * 100.0;
+      fprintf(stderr, " %+7.1f%%", change);
+
+      if (change > threshold &&
+          result.median_ns - baseline_median > 3.0 * baseline_mad)
+      {
+        fprintf(stderr, " REGRESSION");
+        regressions_count++;
+      }
+    }
+    fprintf(stderr, "\n");
+
+    i++;
+  }
+
+  printf("  ]\n}\n");
+
+  fclose(context.packer_output);
+  roonium_arena__free(&context.arena);
+  free(context.jpg.data);
+  free(context.png.data);
+  free(baseline.data);
+  free(baseline_copy);
+
+  if (regressions_count)
+  {
+    fprintf(stderr, "[ ERROR ]:\t %u benchmark(s) slower than the baseline by more than %.1f%%!\n",
+            (unsigned int)regressions_count,
+            threshold);
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 a_position;
+/* Per draw with multi-draw indirect, picked by base instance. */
+layout (location = 3) in mat4 a_model;
+uniform mat4 u_projection;
+uniform mat4 u_view;
+uniform mat4 u_model;
+uniform bool u_indirect;
+/* Same transform as shader.vs, so the opaque pass matches with GL_LEQUAL. */
+invariant gl_Position;
+
+void main() {
+    mat4 model = u_indirect ? a_model : u_model;
+    vec3 fragment_position = vec3(model * vec4(a_position, 1.0f));
+    vec4 view_position = u_view * vec4(fragment_position, 1.0);
+
+    gl_Position = u_projection * view_position;
+};
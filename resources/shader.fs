@@ -1,22 +1,55 @@
-#version 330 core
-in vec2 texture_coordinates;
-in vec3 normal;
-in vec3 fragment_position;
-uniform sampler2D texture0;
-
-float ambient_strength = 0.4;
-float diffuse_strength = 0.5;
-vec3 ambient_color = vec3(0.9, 0.9, 0.9);
-vec3 light_color = vec3(0.9, 0.9, 0.9);
-vec3 light_position = vec3(2.0, 1.0, 2.0);
-
-void main() {
-    vec3 normalized_normal = normalize(normal);
-    vec3 light_direction = normalize(light_position - fragment_position);
-    float difference = max(dot(normalized_normal, light_direction), 0.0);
-    vec3 diffuse = difference * light_color;
-    vec3 result = (ambient_strength * ambient_color) + (diffuse * diffuse_strength);
-    
-    gl_FragColor = vec4(result, 1.0) * texture(texture0, texture_coordinates);
-};
-
+#version 330 core
+in vec2 texture_coordinates;
+flat in float texture_layer;
+in vec3 normal;
+in vec3 fragment_position;
+in float view_depth;
+in float alpha;
+uniform sampler2DArray texture0;
+
+/* Clustered lights. Every light is two texels: position and radius,
+ * color and intensity. A cluster is the first index and the count of
+ * its lights in u_light_indices. The *_first uniforms are where this
+ * frame starts in each buffer. */
+uniform samplerBuffer u_lights;
+uniform usamplerBuffer u_clusters;
+uniform usamplerBuffer u_light_indices;
+uniform int u_lights_first;
+uniform int u_clusters_first;
+uniform int u_light_indices_first;
+uniform ivec3 u_clusters_size;
+uniform float u_clusters_near;
+uniform float u_clusters_depth_scale;
+uniform vec2 u_screen_size;
+uniform vec3 u_ambient_color;
+
+float diffuse_strength = 0.5;
+
+void main() {
+    vec3 normalized_normal = normalize(normal);
+    vec3 result = u_ambient_color;
+    ivec3 cluster;
+    uvec2 lights;
+    uint i;
+
+    cluster.xy = ivec2(gl_FragCoord.xy / u_screen_size * vec2(u_clusters_size.xy));
+    cluster.z = int(log(max(view_depth, u_clusters_near) / u_clusters_near) * u_clusters_depth_scale);
+    cluster = clamp(cluster, ivec3(0), u_clusters_size - 1);
+    lights = texelFetch(
+        u_clusters,
+        u_clusters_first + cluster.x + u_clusters_size.x * (cluster.y + u_clusters_size.y * cluster.z)).xy;
+
+    for (i = 0u; i < lights.y; i++) {
+        int light = int(texelFetch(u_light_indices, u_light_indices_first + int(lights.x + i)).r);
+        vec4 position_radius = texelFetch(u_lights, u_lights_first + light * 2);
+        vec4 color_intensity = texelFetch(u_lights, u_lights_first + light * 2 + 1);
+        vec3 light_direction = position_radius.xyz - fragment_position;
+        float distance_squared = dot(light_direction, light_direction);
+        float falloff = clamp(1.0 - distance_squared / (position_radius.w * position_radius.w), 0.0, 1.0);
+        float difference = max(dot(normalized_normal, normalize(light_direction)), 0.0);
+
+        result += difference * falloff * falloff * color_intensity.w * color_intensity.rgb * diffuse_strength;
+    }
+
+    gl_FragColor = vec4(result, alpha) * texture(texture0, vec3(texture_coordinates, texture_layer));
+};
@@ -1,18 +1,39 @@
-#version 330 core
-layout (location = 0) in vec3 a_position;
-layout (location = 1) in vec3 a_normal;
-layout (location = 2) in vec2 a_texture_coordinates;
-uniform mat4 u_projection;
-uniform mat4 u_view;
-uniform mat4 u_model;
-out vec2 texture_coordinates;
-out vec3 normal;
-out vec3 fragment_position;
-
-void main() {
-    texture_coordinates = vec2(a_texture_coordinates.x, 1.0-a_texture_coordinates.y);
-    normal = mat3(transpose(inverse(u_model))) * a_normal;
-    fragment_position = vec3(u_model * vec4(a_position, 1.0f));
-    gl_Position = u_projection * u_view * u_model *  vec4(a_position, 1.0);
-};
-
+#version 330 core
+layout (location = 0) in vec3 a_position;
+layout (location = 1) in vec3 a_normal;
+layout (location = 2) in vec2 a_texture_coordinates;
+/* Per draw with multi-draw indirect, picked by base instance. */
+layout (location = 3) in mat4 a_model;
+layout (location = 7) in vec4 a_texture_rect;
+layout (location = 8) in vec2 a_alpha_layer;
+uniform mat4 u_projection;
+uniform mat4 u_view;
+uniform mat4 u_model;
+uniform float u_alpha;
+uniform bool u_indirect;
+/* Where the texture sits in the array: u, v, width, height and layer. */
+uniform vec4 u_texture_rect;
+uniform float u_texture_layer;
+out vec2 texture_coordinates;
+flat out float texture_layer;
+out vec3 normal;
+out vec3 fragment_position;
+out float view_depth;
+out float alpha;
+/* The depth prepass in depth.vs must produce the same depth. */
+invariant gl_Position;
+
+void main() {
+    mat4 model = u_indirect ? a_model : u_model;
+    vec4 texture_rect = u_indirect ? a_texture_rect : u_texture_rect;
+    vec4 view_position;
+
+    texture_coordinates = texture_rect.xy + vec2(a_texture_coordinates.x, 1.0-a_texture_coordinates.y) * texture_rect.zw;
+    texture_layer = u_indirect ? a_alpha_layer.y : u_texture_layer;
+    normal = mat3(transpose(inverse(model))) * a_normal;
+    fragment_position = vec3(model * vec4(a_position, 1.0f));
+    view_position = u_view * vec4(fragment_position, 1.0);
+    view_depth = -view_position.z;
+    alpha = u_indirect ? a_alpha_layer.x : u_alpha;
+    gl_Position = u_projection * view_position;
+};
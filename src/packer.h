@@ -0,0 +1,18 @@
+#ifndef PACKER_H
+#define PACKER_H
+
+#include <stdio.h>
+
+typedef struct buffer
+{
+	unsigned char *data;
+	size_t size;
+} buffer;
+
+struct buffer loadFile(const char *_path, const char *_mode);
+
+void writePackedArray(
+	FILE *_output,
+	const char *_input_path,
+	const struct buffer _input);
+#endif
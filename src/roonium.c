@@ -1,669 +1,2111 @@
-#include <stdio.h>
-#include <stdbool.h>
-#include <math.h>
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
-#include <malloc.h>
-#include <roonmath.h>
-
-#include "shader.vs.h"
-#include "shader.fs.h"
-#include "roon.h"
-#include "roon_icon.h"
-
-/* stb_image implementation? */
-unsigned char *stbi_load_from_memory(unsigned char const *buffer, int len, int *x, int *y, int *channels_in_file, int desired_channels);
-
-#ifndef UNUSED
-#define UNUSED(_v) (void)(_v)
-#endif
-
-/* Vertex. */
-typedef struct roonium_vertex
-{
-  roonium_vector3 position;
-  roonium_vector3 normals;
-  roonium_vector2 texture_coordinates;
-} roonium_vertex;
-
-/* Static mesh. */
-typedef struct roonium_mesh
-{
-  GLuint vbo, vao;
-  roonium_vertex *vertices;
-  size_t vertices_count;
-} roonium_mesh;
-
-/* Static mesh. */
-typedef struct roonium_camera3d
-{
-  roonium_vector3 position;
-  roonium_vector3 up;
-  roonium_vector3 target;
-  float fov;
-  float aspect;
-} roonium_camera3d;
-
-typedef struct roonium_app_settings
-{
-  int window_width;
-  int window_height;
-  const char *window_title;
-  int window_target_fps;
-} roonium_app_settings;
-
-typedef struct roonium_app
-{
-  GLFWwindow *window;
-  bool window_quit;
-  int frames_count;
-  int fps;
-  double frames_time_last_fps;
-  double frames_time_last;
-  double frames_time_now;
-
-  GLuint shader, texture;
-  struct roonium_mesh mesh;
-  struct roonium_camera3d camera;
-
-  roonium_app_settings settings;
-} roonium_app;
-
-struct roonium_mesh generate_mesh_pyramid(
-    const float _x,
-    const float _y,
-    const float _z)
-{
-  struct roonium_mesh mesh;
-  roonium_vector3 n, va, vb, vc;
-  roonium_vector2 ta, tb, tc;
-  int i = 0;
-
-  mesh.vertices_count = 18;
-  mesh.vertices = malloc(
-      mesh.vertices_count *
-      sizeof(struct roonium_vertex));
-
-  /* Toward. */
-  {
-    va.x = -_x / 2.0f;
-    va.y = -_y / 2.0;
-    va.z = _z / 2.0f;
-    ta.x = 0.0f;
-    ta.y = 0.0f;
-
-    vb.x = _x / 2.0f;
-    vb.y = -_y / 2.0;
-    vb.z = _z / 2.0f;
-    tb.x = 1.0f;
-    tb.y = 0.0f;
-
-    vc.x = 0.0f;
-    vc.y = _y / 2.0;
-    vc.z = 0.0f;
-    tc.x = 0.5f;
-    tc.y = 1.0f;
-
-    n = get_normal(va, vb, vc);
-
-    mesh.vertices[i + 0].position = va;
-    mesh.vertices[i + 1].position = vb;
-    mesh.vertices[i + 2].position = vc;
-    mesh.vertices[i + 0].normals = n;
-    mesh.vertices[i + 1].normals = n;
-    mesh.vertices[i + 2].normals = n;
-    mesh.vertices[i + 0].texture_coordinates = ta;
-    mesh.vertices[i + 1].texture_coordinates = tb;
-    mesh.vertices[i + 2].texture_coordinates = tc;
-
-    i += 3;
-  }
-
-  /* Backward. */
-  {
-    va.x = _x / 2.0f;
-    va.y = -_y / 2.0;
-    va.z = -_z / 2.0f;
-    ta.x = 0.0f;
-    ta.y = 0.0f;
-    vb.x = -_x / 2.0f;
-    vb.y = -_y / 2.0;
-    vb.z = -_z / 2.0f;
-    tb.x = 1.0f;
-    tb.y = 0.0f;
-    vc.x = 0.0f;
-    vc.y = _y / 2.0;
-    vc.z = 0.0f;
-    tc.x = 0.5f;
-    tc.y = 1.0f;
-
-    n = get_normal(va, vb, vc);
-
-    mesh.vertices[i + 0].position = va;
-    mesh.vertices[i + 1].position = vb;
-    mesh.vertices[i + 2].position = vc;
-    mesh.vertices[i + 0].normals = n;
-    mesh.vertices[i + 1].normals = n;
-    mesh.vertices[i + 2].normals = n;
-    mesh.vertices[i + 0].texture_coordinates = ta;
-    mesh.vertices[i + 1].texture_coordinates = tb;
-    mesh.vertices[i + 2].texture_coordinates = tc;
-
-    i += 3;
-  }
-
-  /* left. */
-  {
-    va.x = -_x / 2.0f;
-    va.y = -_y / 2.0;
-    va.z = -_z / 2.0f;
-    ta.x = 0.0f;
-    ta.y = 0.0f;
-    vb.x = -_x / 2.0f;
-    vb.y = -_y / 2.0;
-    vb.z = _z / 2.0f;
-    tb.x = 1.0f;
-    tb.y = 0.0f;
-    vc.x = 0.0f;
-    vc.y = _y / 2.0;
-    vc.z = 0.0f;
-    tc.x = 0.5f;
-    tc.y = 1.0f;
-
-    n = get_normal(va, vb, vc);
-
-    mesh.vertices[i + 0].position = va;
-    mesh.vertices[i + 1].position = vb;
-    mesh.vertices[i + 2].position = vc;
-    mesh.vertices[i + 0].normals = n;
-    mesh.vertices[i + 1].normals = n;
-    mesh.vertices[i + 2].normals = n;
-    mesh.vertices[i + 0].texture_coordinates = ta;
-    mesh.vertices[i + 1].texture_coordinates = tb;
-    mesh.vertices[i + 2].texture_coordinates = tc;
-
-    i += 3;
-  }
-
-  /* Right. */
-  {
-    va.x = _x / 2.0f;
-    va.y = -_y / 2.0;
-    va.z = _z / 2.0f;
-    ta.x = 0.0f;
-    ta.y = 0.0f;
-    vb.x = _x / 2.0f;
-    vb.y = -_y / 2.0;
-    vb.z = -_z / 2.0f;
-    tb.x = 1.0f;
-    tb.y = 0.0f;
-    vc.x = 0.0f;
-    vc.y = _y / 2.0;
-    vc.z = 0.0f;
-    tc.x = 0.5f;
-    tc.y = 1.0f;
-
-    n = get_normal(va, vb, vc);
-
-    mesh.vertices[i + 0].position = va;
-    mesh.vertices[i + 1].position = vb;
-    mesh.vertices[i + 2].position = vc;
-    mesh.vertices[i + 0].normals = n;
-    mesh.vertices[i + 1].normals = n;
-    mesh.vertices[i + 2].normals = n;
-    mesh.vertices[i + 0].texture_coordinates = ta;
-    mesh.vertices[i + 1].texture_coordinates = tb;
-    mesh.vertices[i + 2].texture_coordinates = tc;
-
-    i += 3;
-  }
-
-  /* Bottom square. */
-  {
-    va.x = -_x / 2.0f;
-    va.y = -_y / 2.0;
-    va.z = -_z / 2.0f;
-    ta.x = 0.0f;
-    ta.y = 1.0f;
-    vb.x = _x / 2.0f;
-    vb.y = -_y / 2.0;
-    vb.z = -_z / 2.0f;
-    tb.x = 1.0f;
-    tb.y = 1.0f;
-    vc.x = -_x / 2.0f;
-    vc.y = -_y / 2.0;
-    vc.z = _z / 2.0f;
-    tc.x = 0.0f;
-    tc.y = 0.0f;
-
-    n = get_normal(va, vb, vc);
-
-    mesh.vertices[i + 0].position = va;
-    mesh.vertices[i + 1].position = vb;
-    mesh.vertices[i + 2].position = vc;
-    mesh.vertices[i + 0].normals = n;
-    mesh.vertices[i + 1].normals = n;
-    mesh.vertices[i + 2].normals = n;
-    mesh.vertices[i + 0].texture_coordinates = ta;
-    mesh.vertices[i + 1].texture_coordinates = tb;
-    mesh.vertices[i + 2].texture_coordinates = tc;
-    i += 3;
-
-    va.x = -_x / 2.0f;
-    va.y = -_y / 2.0;
-    va.z = _z / 2.0f;
-    ta.x = 1.0f;
-    ta.y = 0.0f;
-    vb.x = _x / 2.0f;
-    vb.y = -_y / 2.0;
-    vb.z = -_z / 2.0f;
-    tb.x = 0.0f;
-    tb.y = 1.0f;
-    vc.x = _x / 2.0f;
-    vc.y = -_y / 2.0;
-    vc.z = _z / 2.0f;
-    tc.x = 0.0f;
-    tc.y = 0.0f;
-
-    mesh.vertices[i + 0].position = va;
-    mesh.vertices[i + 1].position = vb;
-    mesh.vertices[i + 2].position = vc;
-    mesh.vertices[i + 0].normals = n;
-    mesh.vertices[i + 1].normals = n;
-    mesh.vertices[i + 2].normals = n;
-    mesh.vertices[i + 0].texture_coordinates = ta;
-    mesh.vertices[i + 1].texture_coordinates = tb;
-    mesh.vertices[i + 2].texture_coordinates = tc;
-  }
-
-  glGenVertexArrays(1, &mesh.vao);
-  glBindVertexArray(mesh.vao);
-  glGenBuffers(1, &mesh.vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
-  glBufferData(
-      GL_ARRAY_BUFFER,
-      mesh.vertices_count * sizeof(roonium_vertex),
-      mesh.vertices,
-      GL_STATIC_DRAW);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(
-      0,
-      3,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(roonium_vertex),
-      (GLvoid *)offsetof(roonium_vertex, position));
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(
-      1,
-      3,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(roonium_vertex),
-      (GLvoid *)offsetof(roonium_vertex, normals));
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(
-      2,
-      2,
-      GL_FLOAT,
-      GL_FALSE,
-      sizeof(roonium_vertex),
-      (GLvoid *)offsetof(roonium_vertex, texture_coordinates));
-
-  return mesh;
-}
-
-void draw_mesh(
-    const struct roonium_mesh _mesh)
-{
-  glBindVertexArray(_mesh.vao);
-  glDrawArrays(
-      GL_TRIANGLES,
-      0,
-      _mesh.vertices_count);
-  glBindVertexArray(0);
-}
-
-void camera3d_get_projection(
-    roonium_matrix _destination,
-    const struct roonium_camera3d _camera)
-{
-  matrix_identity(_destination);
-  matrix_perspective(
-      _destination,
-      _camera.fov,
-      _camera.aspect,
-      0.1f,
-      100.0f);
-}
-
-void camera3d_get_view(
-    roonium_matrix _destination,
-    const struct roonium_camera3d _camera)
-{
-  matrix_identity(_destination);
-  matrix_look_at(
-      _destination,
-      _camera.position,
-      _camera.target,
-      _camera.up);
-}
-
-GLuint load_shader_from_code(
-    const char *_vs_code,
-    const char *_fs_code)
-{
-  GLuint id, v_id, f_id;
-  int program_validate = 0;
-  char info[512];
-
-  v_id = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(v_id, 1, &_vs_code, NULL);
-  glCompileShader(v_id);
-
-  f_id = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(f_id, 1, &_fs_code, NULL);
-  glCompileShader(f_id);
-
-  id = glCreateProgram();
-  glAttachShader(id, v_id);
-  glAttachShader(id, f_id);
-  glLinkProgram(id);
-
-  glValidateProgram(id);
-  glGetProgramiv(id, GL_VALIDATE_STATUS, &program_validate);
-
-  if (!program_validate)
-  {
-    glGetProgramInfoLog(id, 512, NULL, info);
-    printf("Shader compilation error: %s\n", info);
-    glDeleteShader(v_id);
-    glDeleteShader(f_id);
-    glDeleteProgram(id);
-
-    id = (GLuint)-1;
-
-    return id;
-  };
-
-  glDeleteShader(v_id);
-  glDeleteShader(f_id);
-
-  return id;
-}
-
-GLuint load_texture_from_memory(
-    const unsigned char *_data,
-    const size_t _size)
-{
-  GLuint id;
-  int w, h;
-  uint8_t *data;
-  data = stbi_load_from_memory(
-      _data,
-      _size,
-      &w,
-      &h,
-      0,
-      4);
-
-  if (!data)
-    return -1;
-
-  glGenTextures(1, &id);
-  glBindTexture(GL_TEXTURE_2D, id);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glGenerateMipmap(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, 0);
-
-  free(data);
-
-  return id;
-}
-
-void roonium_app__swap_buffers(
-    struct roonium_app *_app)
-{
-  glfwSwapBuffers(_app->window);
-  /* Set end drawing time. */
-  _app->frames_time_last = _app->frames_time_now;
-}
-
-void roonium_app__begin_frame(
-    struct roonium_app *_app)
-{
-  _app->frames_count++;
-  _app->frames_time_now = glfwGetTime();
-  if (_app->frames_time_now - _app->frames_time_last_fps > 1.0)
-  {
-    _app->frames_time_last_fps = _app->frames_time_now;
-    _app->fps = _app->frames_count;
-    _app->frames_count = 0;
-  }
-
-  glfwGetFramebufferSize(
-      _app->window,
-      &_app->settings.window_width,
-      &_app->settings.window_height);
-
-  _app->camera.aspect =
-      (float)_app->settings.window_width /
-      (float)_app->settings.window_height;
-
-  glViewport(
-      0,
-      0,
-      _app->settings.window_width,
-      _app->settings.window_height);
-  glClearColor(0.9f, 0.9f, 0.9f, 1.0f);
-  glClear(GL_COLOR_BUFFER_BIT);
-
-  /* Draw.*/
-  glUseProgram(_app->shader);
-}
-
-int roonium_app__cull_frame(
-    struct roonium_app *_app)
-{
-  _app->frames_time_now = glfwGetTime();
-
-  if ((_app->frames_time_now - _app->frames_time_last) <=
-      (1.0 / (double)_app->settings.window_target_fps))
-  {
-    return 1;
-  }
-  return 0;
-}
-
-static void error_callback(int _error, const char *_description)
-{
-  UNUSED(_error);
-  fprintf(stderr, "Error: %s\n", _description);
-}
-
-int roonium_app__init(
-    struct roonium_app *_app)
-{
-  glfwSetErrorCallback(error_callback);
-  if (!glfwInit())
-  {
-    printf("Cannot initialize GLFW.\n");
-    return 1;
-  }
-  glfwWindowHint(GLFW_DEPTH_BITS, 16);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-  glfwWindowHint(GLFW_SAMPLES, 1);
-
-  _app->settings.window_width = 800;
-  _app->settings.window_height = 600;
-  _app->settings.window_title = "Roonium";
-  _app->settings.window_target_fps = 60;
-  _app->frames_count = 0;
-  _app->frames_time_last_fps = 0.0;
-  _app->frames_time_last = 0.0;
-  _app->frames_time_now = 0.0;
-  _app->fps = _app->settings.window_target_fps;
-
-  _app->camera.position.x = 0.0f;
-  _app->camera.position.y = 1.0f;
-  _app->camera.position.z = 3.0f;
-  _app->camera.target.x = 0.0f;
-  _app->camera.target.y = 0.0f;
-  _app->camera.target.z = 0.0f;
-  _app->camera.up.x = 0.0f;
-  _app->camera.up.y = 1.0f;
-  _app->camera.up.z = 0.0f;
-  _app->camera.fov = 45.0f;
-  _app->camera.aspect = 800.0f / 600.0f;
-
-  return 0;
-}
-
-int roonium_app__run(
-    struct roonium_app *_app)
-{
-  char title[512];
-  GLFWimage window_icon;
-  roonium_matrix projection, view, model;
-
-  _app->window = glfwCreateWindow(
-      _app->settings.window_width,
-      _app->settings.window_height,
-      _app->settings.window_title,
-      NULL,
-      NULL);
-  _app->window_quit = false;
-
-  glfwMakeContextCurrent(_app->window);
-  gladLoadGL();
-  glEnable(GL_BLEND);
-  glEnable(GL_CULL_FACE);
-  glCullFace(GL_BACK);
-  glFrontFace(GL_CCW);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-  _app->mesh = generate_mesh_pyramid(1.25f, 1.0f, 1.25f);
-  _app->shader = load_shader_from_code(
-      (const char *)RESOURCES_SHADER_VS,
-      (const char *)RESOURCES_SHADER_FS);
-  _app->texture = load_texture_from_memory(
-      RESOURCES_ROON_JPG,
-      RESOURCES_ROON_JPG_SIZE);
-
-  /* Set icon */
-  {
-    window_icon.pixels = stbi_load_from_memory(
-        RESOURCES_ROON_ICON_PNG,
-        RESOURCES_ROON_ICON_PNG_SIZE,
-        &window_icon.width,
-        &window_icon.height,
-        0,
-        4);
-
-    glfwSetWindowIcon(
-        _app->window,
-        1,
-        &window_icon);
-
-    window_icon.width = 0;
-    window_icon.height = 0;
-    free(window_icon.pixels);
-  }
-
-  while (!_app->window_quit)
-  {
-    /* Fixed FPS. */
-    if (roonium_app__cull_frame(_app))
-    {
-      continue;
-    }
-
-    /* Events. */
-    {
-      glfwPollEvents();
-      _app->window_quit |= glfwWindowShouldClose(_app->window);
-      _app->window_quit |= glfwGetKey(_app->window, GLFW_KEY_ESCAPE);
-
-      sprintf(
-          title,
-          "Roonium; FPS: %i",
-          _app->fps);
-
-      glfwSetWindowTitle(_app->window, title);
-    }
-
-    /* Set shader uniforms. */
-    {
-      camera3d_get_projection(
-          projection,
-          _app->camera);
-      glUniformMatrix4fv(
-          glGetUniformLocation(
-              _app->shader,
-              "u_projection"),
-          1,
-          GL_FALSE,
-          (const float *)&projection);
-
-      camera3d_get_view(view, _app->camera);
-      glUniformMatrix4fv(
-          glGetUniformLocation(_app->shader, "u_view"),
-          1,
-          GL_FALSE,
-          (const float *)&view);
-
-      matrix_identity(model);
-      matrix_rotate_y(model, model, (float)glfwGetTime() * 3.0f);
-      glUniformMatrix4fv(
-          glGetUniformLocation(_app->shader, "u_model"),
-          1,
-          GL_FALSE,
-          (const float *)&model);
-    }
-
-    /* Drawing */
-    {
-      roonium_app__begin_frame(_app);
-
-      glUseProgram(_app->shader);
-      glBindTexture(GL_TEXTURE_2D, _app->texture);
-      draw_mesh(_app->mesh);
-
-      roonium_app__swap_buffers(_app);
-    }
-  }
-
-  return 0;
-}
-
-void roonium_app__quit(
-    struct roonium_app *_app)
-{
-
-  glUseProgram(0);
-  glDisableVertexAttribArray(0);
-  glDisableVertexAttribArray(1);
-  glDeleteProgram(_app->shader);
-  glDeleteBuffers(1, &_app->mesh.vbo);
-  glDeleteVertexArrays(1, &_app->mesh.vao);
-  free(_app->mesh.vertices);
-  glfwDestroyWindow(_app->window);
-  glfwTerminate();
-}
-
-int main()
-{
-  struct roonium_app app;
-
-  if (roonium_app__init(&app) ||
-      roonium_app__run(&app))
-    return 1;
-
-  roonium_app__quit(&app);
-
-  return 0;
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <malloc.h>
+#include <roonmath.h>
+
+#include "roonium_memory.h"
+#include "roonium_mesh.h"
+#include "roonium_jobs.h"
+#include "roonium_lights.h"
+#include "roonium_indirect.h"
+#include "roonium_textures.h"
+#include "roonium_resolution.h"
+#include "roonium_sort.h"
+#include "roonium_stream.h"
+
+#include "shader.vs.h"
+#include "shader.fs.h"
+#include "depth.vs.h"
+#include "depth.fs.h"
+#include "roon.h"
+#include "roon_icon.h"
+
+/* stb_image implementation? */
+unsigned char *stbi_load_from_memory(unsigned char const *buffer, int len, int *x, int *y, int *channels_in_file, int desired_channels);
+
+#ifndef UNUSED
+#define UNUSED(_v) (void)(_v)
+#endif
+
+#define ROONIUM_FRAME_ARENA_SIZE (32 * 1024 * 1024)
+#define ROONIUM_FRAMES_PREPARED 2
+#define ROONIUM_PREPARE_GRAIN 1024
+#define ROONIUM_SORT_GRAIN 4096
+#define ROONIUM_MESHES_MAX 16
+#define ROONIUM_SCENE_NODES_MAX (128 * 1024)
+#define ROONIUM_STREAM_SIZE (6 * 1024 * 1024)
+#define ROONIUM_STREAM_BENCHMARK_SIDE 32
+#define ROONIUM_LOD_BENCHMARK_SIDE 16
+#define ROONIUM_SWARM_BENCHMARK_SIDE 320
+#define ROONIUM_CAMERA_NEAR 0.1f
+#define ROONIUM_CAMERA_FAR 100.0f
+#define ROONIUM_LIGHTS_COUNT 256
+/* Lights, clusters and light indices of the frames in flight, room for
+ * ROONIUM_CLUSTERS_INDICES_MAX indices in each. */
+#define ROONIUM_LIGHTS_STREAM_SIZE (1024 * 1024)
+#define ROONIUM_GEOMETRY_VERTICES_MAX (128 * 1024)
+#define ROONIUM_GEOMETRY_INDICES_MAX (512 * 1024)
+/* Draw commands and instances of the frames in flight. A frame that does
+ * not fit falls back to one call per draw. */
+#define ROONIUM_INDIRECT_STREAM_SIZE (32 * 1024 * 1024)
+
+/* Static mesh. Its vertices and indices live in the VAO's buffers from
+ * vertices_first and lods[].indices_first on. */
+typedef struct roonium_mesh
+{
+  GLuint vao;
+  size_t vertices_first;
+  size_t vertices_count;
+  struct roonium_lod_level lods[ROONIUM_LOD_LEVELS_MAX];
+  size_t lods_count;
+  float radius;
+} roonium_mesh;
+
+/* Scene node. */
+typedef struct roonium_scene_node
+{
+  roonium_vector3 position;
+  float rotation_y;
+  float rotation_speed;
+  float alpha;
+  struct roonium_mesh *mesh;
+  size_t lod;
+  unsigned int texture;
+} roonium_scene_node;
+
+/* Draw call. */
+typedef struct roonium_render_item
+{
+  roonium_matrix model;
+  struct roonium_mesh *mesh;
+  size_t lod;
+  const struct roonium_texture_region *texture;
+  float alpha;
+  float depth;
+} roonium_render_item;
+
+/* Draw calls of one pass. Items live in the frame arena, jobs append
+ * to it concurrently. Sorting orders keys, the items stay in place. */
+typedef struct roonium_render_queue
+{
+  struct roonium_render_item *items;
+  volatile long count;
+  long capacity;
+  struct roonium_sort_key *keys;
+  struct roonium_sort_key *keys_scratch;
+  const struct roonium_sort_key *order;
+} roonium_render_queue;
+
+/* Consecutive items of a queue, submitted with one
+ * glMultiDrawArraysIndirect and one glMultiDrawElementsIndirect.
+ * Offsets are in bytes in the indirect buffer. */
+typedef struct roonium_indirect_run
+{
+  size_t arrays_offset;
+  size_t arrays_count;
+  size_t elements_offset;
+  size_t elements_count;
+} roonium_indirect_run;
+
+/* Sort of one queue on the job system. Chunks of ROONIUM_SORT_GRAIN
+ * keys are radix sorted in parallel, then runs of width keys are merged
+ * pairwise from source to destination, one level at a time. */
+typedef struct render_queue_sorter
+{
+  struct roonium_render_queue *queue;
+  bool front_to_back;
+  struct roonium_sort_key *source;
+  struct roonium_sort_key *destination;
+  size_t width;
+} render_queue_sorter;
+
+/* A queue uploaded for multi-draw indirect. No runs means one call per
+ * draw. */
+typedef struct roonium_indirect_batch
+{
+  struct roonium_indirect_run *runs;
+  size_t runs_count;
+} roonium_indirect_batch;
+
+/* CPU side of a frame. Built on the job system while the previous frame
+ * is submitted, so the main thread only touches GL. */
+typedef struct roonium_frame
+{
+  struct roonium_arena arena;
+  struct roonium_render_queue opaque;
+  struct roonium_render_queue transparent;
+  struct roonium_render_queue streamed;
+  struct roonium_indirect_batch opaque_batch;
+  struct roonium_indirect_batch transparent_batch;
+  roonium_matrix projection;
+  roonium_matrix view;
+  roonium_vector4 frustum[6];
+  roonium_vector3 camera_position;
+  float time;
+  bool lod_enabled;
+  const struct roonium_textures *textures;
+
+  /* Lighting. */
+  struct roonium_light *lights;
+  size_t lights_count;
+  struct roonium_clusters clusters;
+
+  /* Scene snapshot. */
+  struct roonium_scene_node **nodes;
+  size_t nodes_count;
+
+  struct roonium_jobs *jobs;
+  struct roonium_job_counter counter;
+  bool prepared;
+  volatile long triangles_count;
+  double prepare_start;
+  double prepare_time;
+} roonium_frame;
+
+typedef enum roonium_benchmark_scene
+{
+  ROONIUM_BENCHMARK_SCENE_NONE,
+  ROONIUM_BENCHMARK_SCENE_LOD,
+  ROONIUM_BENCHMARK_SCENE_SWARM
+} roonium_benchmark_scene;
+
+/* Static mesh. */
+typedef struct roonium_camera3d
+{
+  roonium_vector3 position;
+  roonium_vector3 up;
+  roonium_vector3 target;
+  float fov;
+  float aspect;
+} roonium_camera3d;
+
+typedef struct roonium_app_settings
+{
+  int window_width;
+  int window_height;
+  const char *window_title;
+  int window_target_fps;
+} roonium_app_settings;
+
+typedef struct roonium_app
+{
+  GLFWwindow *window;
+  bool window_quit;
+  int frames_count;
+  int fps;
+  double frames_time_last_fps;
+  double frames_time_last;
+  double frames_time_now;
+
+  GLuint shader, depth_shader;
+  struct roonium_mesh *mesh;
+  struct roonium_mesh *mesh_small;
+  struct roonium_mesh *sphere;
+  struct roonium_camera3d camera;
+
+  /* Every image, packed in one texture array. */
+  struct roonium_textures textures;
+  unsigned int texture;
+  unsigned int texture_icon;
+
+  /* Memory. */
+  struct roonium_pool meshes;
+  struct roonium_pool scene_nodes;
+  struct roonium_scene_node **nodes;
+  size_t nodes_count;
+  size_t nodes_transparent_count;
+  size_t heap_allocations_frame_start;
+  size_t heap_allocations_frame;
+
+  /* Dynamic geometry. */
+  struct roonium_stream stream;
+  struct roonium_mesh *stream_mesh;
+  bool stream_benchmark;
+  size_t stream_bytes_last_fps;
+  double stream_megabytes_per_second;
+
+  /* Frames. */
+  struct roonium_jobs *jobs;
+  struct roonium_frame frames[ROONIUM_FRAMES_PREPARED];
+  size_t frame;
+  double prepare_time;
+
+  /* Dynamic resolution. */
+  struct roonium_resolution resolution;
+
+  /* Passes. */
+  bool depth_prepass;
+  size_t draw_calls_count;
+
+  /* Static geometry and multi-draw indirect. */
+  struct roonium_geometry geometry;
+  struct roonium_indirect indirect;
+  struct roonium_stream indirect_stream;
+  bool indirect_supported;
+  bool indirect_enabled;
+
+  /* Clustered lighting. */
+  size_t lights_count;
+  roonium_vector3 ambient_color;
+  struct roonium_stream lights_stream;
+  GLuint lights_texture;
+  GLuint clusters_texture;
+  GLuint light_indices_texture;
+
+  /* Level of detail. */
+  bool lod_enabled;
+  enum roonium_benchmark_scene benchmark_scene;
+  size_t nodes_base_count;
+  size_t triangles_count;
+  double frame_time;
+
+  int keys[GLFW_KEY_LAST + 1];
+
+  roonium_app_settings settings;
+} roonium_app;
+
+/* Layout of roonium_vertex for the bound VAO and GL_ARRAY_BUFFER. */
+void set_vertex_attributes(void)
+{
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(
+      0,
+      3,
+      GL_FLOAT,
+      GL_FALSE,
+      sizeof(roonium_vertex),
+      (GLvoid *)offsetof(roonium_vertex, position));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(
+      1,
+      3,
+      GL_FLOAT,
+      GL_FALSE,
+      sizeof(roonium_vertex),
+      (GLvoid *)offsetof(roonium_vertex, normals));
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(
+      2,
+      2,
+      GL_FLOAT,
+      GL_FALSE,
+      sizeof(roonium_vertex),
+      (GLvoid *)offsetof(roonium_vertex, texture_coordinates));
+}
+
+/* Vertices are built in _scratch and only live until it is reset. */
+struct roonium_mesh generate_mesh_pyramid(
+    struct roonium_geometry *_geometry,
+    struct roonium_arena *_scratch,
+    const float _x,
+    const float _y,
+    const float _z)
+{
+  struct roonium_mesh mesh;
+  roonium_vertex *vertices;
+  size_t indices_first;
+
+  memset(&mesh, 0, sizeof(mesh));
+  vertices = roonium_arena__alloc(
+      _scratch,
+      ROONIUM_PYRAMID_VERTICES_COUNT * sizeof(struct roonium_vertex));
+
+  if (!vertices)
+    return mesh;
+
+  build_pyramid_vertices(vertices, _x, _y, _z);
+  if (roonium_geometry__append(
+          _geometry,
+          vertices,
+          ROONIUM_PYRAMID_VERTICES_COUNT,
+          NULL,
+          0,
+          &mesh.vertices_first,
+          &indices_first))
+    return mesh;
+
+  mesh.vao = _geometry->vao;
+  mesh.vertices_count = ROONIUM_PYRAMID_VERTICES_COUNT;
+  mesh.radius = (float)sqrt(_x * _x + _y * _y + _z * _z) / 2.0f;
+
+  return mesh;
+}
+
+/* Sphere with all its levels of detail one after another. */
+struct roonium_mesh generate_mesh_lod_sphere(
+    struct roonium_geometry *_geometry,
+    struct roonium_arena *_scratch,
+    const float _radius,
+    const float _bumpiness,
+    const size_t _rings,
+    const size_t _segments)
+{
+  struct roonium_mesh mesh;
+  struct roonium_mesh_data data;
+  size_t indices_first, i = 0;
+
+  memset(&mesh, 0, sizeof(mesh));
+  if (build_mesh_data_sphere(
+          &data,
+          _scratch,
+          _radius,
+          _bumpiness,
+          _rings,
+          _segments) ||
+      build_mesh_data_lods(&data, _scratch, ROONIUM_LOD_LEVELS_MAX) ||
+      roonium_geometry__append(
+          _geometry,
+          data.vertices,
+          data.vertices_count,
+          data.indices,
+          data.indices_count,
+          &mesh.vertices_first,
+          &indices_first))
+    return mesh;
+
+  mesh.vao = _geometry->vao;
+  mesh.vertices_count = data.vertices_count;
+  mesh.lods_count = data.lods_count;
+  memcpy(mesh.lods, data.lods, sizeof(mesh.lods));
+  while (i < mesh.lods_count)
+    mesh.lods[i++].indices_first += indices_first;
+  mesh.radius = data.radius;
+
+  return mesh;
+}
+
+size_t mesh_triangles_count(
+    const struct roonium_mesh *_mesh,
+    const size_t _lod)
+{
+  if (!_mesh->lods_count)
+    return _mesh->vertices_count / 3;
+
+  return _mesh->lods[_lod].indices_count / 3;
+}
+
+void draw_mesh_lod(
+    const struct roonium_mesh _mesh,
+    const size_t _lod)
+{
+  glBindVertexArray(_mesh.vao);
+  if (_mesh.lods_count)
+  {
+    glDrawElementsBaseVertex(
+        GL_TRIANGLES,
+        _mesh.lods[_lod].indices_count,
+        GL_UNSIGNED_INT,
+        (GLvoid *)(_mesh.lods[_lod].indices_first * sizeof(unsigned int)),
+        _mesh.vertices_first);
+  }
+  else
+  {
+    glDrawArrays(
+        GL_TRIANGLES,
+        _mesh.vertices_first,
+        _mesh.vertices_count);
+  }
+  glBindVertexArray(0);
+}
+
+void draw_mesh(
+    const struct roonium_mesh _mesh)
+{
+  draw_mesh_lod(_mesh, 0);
+}
+
+void render_queue_begin(
+    struct roonium_render_queue *_queue,
+    struct roonium_arena *_arena,
+    const size_t _capacity)
+{
+  _queue->items = roonium_arena__alloc(
+      _arena,
+      _capacity * sizeof(struct roonium_render_item));
+  _queue->keys = roonium_arena__alloc(
+      _arena,
+      _capacity * sizeof(struct roonium_sort_key));
+  _queue->keys_scratch = roonium_arena__alloc(
+      _arena,
+      _capacity * sizeof(struct roonium_sort_key));
+  _queue->order = NULL;
+  _queue->count = 0;
+  _queue->capacity =
+      _queue->items && _queue->keys && _queue->keys_scratch
+          ? (long)_capacity
+          : 0;
+}
+
+/* Safe to call from several jobs at once. */
+struct roonium_render_item *render_queue_push(
+    struct roonium_render_queue *_queue)
+{
+  const long index = roonium_atomic__add(&_queue->count, 1) - 1;
+
+  if (index >= _queue->capacity)
+    return NULL;
+
+  return &_queue->items[index];
+}
+
+/* _index-th item in draw order. */
+const struct roonium_render_item *render_queue_item(
+    const struct roonium_render_queue *_queue,
+    const long _index)
+{
+  return &_queue->items[_queue->order ? _queue->order[_index].index
+                                      : (unsigned int)_index];
+}
+
+/* Opaque queue goes front to back so early-Z rejects hidden fragments,
+ * transparent queue goes back to front for correct blending. */
+void render_queue_sorter__init(
+    struct render_queue_sorter *_sorter,
+    struct roonium_render_queue *_queue,
+    const bool _front_to_back)
+{
+  /* Pushes past the capacity were dropped. */
+  if (_queue->count > _queue->capacity)
+    _queue->count = _queue->capacity;
+
+  _sorter->queue = _queue;
+  _sorter->front_to_back = _front_to_back;
+  _sorter->source = _queue->keys;
+  _sorter->destination = _queue->keys_scratch;
+  _sorter->width = ROONIUM_SORT_GRAIN;
+}
+
+/* Job: depth keys of items [_begin, _end), radix sorted in place. */
+static void render_queue_sort_chunk(
+    void *_sorter,
+    size_t _begin,
+    size_t _end)
+{
+  struct render_queue_sorter *sorter = _sorter;
+  struct roonium_render_queue *queue = sorter->queue;
+  const struct roonium_sort_key *sorted;
+  unsigned int key;
+  size_t i = _begin;
+
+  while (i < _end)
+  {
+    key = roonium_sort__float_key(queue->items[i].depth);
+    queue->keys[i].key = sorter->front_to_back ? key : ~key;
+    queue->keys[i].index = (unsigned int)i;
+    i++;
+  }
+
+  sorted = roonium_sort__radix(
+      queue->keys + _begin,
+      queue->keys_scratch + _begin,
+      _end - _begin);
+  if (sorted != queue->keys + _begin)
+    memcpy(
+        queue->keys + _begin,
+        sorted,
+        (_end - _begin) * sizeof(struct roonium_sort_key));
+}
+
+/* Job: merges the two runs of [_begin, _end). */
+static void render_queue_merge_runs(
+    void *_sorter,
+    size_t _begin,
+    size_t _end)
+{
+  const struct render_queue_sorter *sorter = _sorter;
+  const size_t middle =
+      _end - _begin > sorter->width ? _begin + sorter->width : _end;
+
+  roonium_sort__merge(
+      sorter->source + _begin,
+      middle - _begin,
+      sorter->source + middle,
+      _end - middle,
+      sorter->destination + _begin);
+}
+
+/* Sorts the queues of _sorters together on _jobs, joining on _counter
+ * between levels. Items stay in place, queue->order gets the keys. */
+void render_queue_sort(
+    struct roonium_jobs *_jobs,
+    struct roonium_job_counter *_counter,
+    struct render_queue_sorter *_sorters,
+    const size_t _count)
+{
+  struct render_queue_sorter *sorter;
+  struct roonium_sort_key *swap;
+  size_t i = 0;
+  bool merging = true;
+
+  while (i < _count)
+  {
+    sorter = &_sorters[i++];
+    roonium_jobs__parallel_for(
+        _jobs,
+        _counter,
+        render_queue_sort_chunk,
+        sorter,
+        (size_t)sorter->queue->count,
+        ROONIUM_SORT_GRAIN);
+  }
+  roonium_jobs__join(_jobs, _counter);
+
+  while (merging)
+  {
+    merging = false;
+    i = 0;
+    while (i < _count)
+    {
+      sorter = &_sorters[i++];
+      if (sorter->width >= (size_t)sorter->queue->count)
+        continue;
+      roonium_jobs__parallel_for(
+          _jobs,
+          _counter,
+          render_queue_merge_runs,
+          sorter,
+          (size_t)sorter->queue->count,
+          sorter->width * 2);
+      merging = true;
+    }
+    roonium_jobs__join(_jobs, _counter);
+
+    i = 0;
+    while (i < _count)
+    {
+      sorter = &_sorters[i++];
+      if (sorter->width >= (size_t)sorter->queue->count)
+        continue;
+      swap = sorter->source;
+      sorter->source = sorter->destination;
+      sorter->destination = swap;
+      sorter->width *= 2;
+    }
+  }
+
+  i = 0;
+  while (i < _count)
+  {
+    _sorters[i].queue->order = _sorters[i].source;
+    i++;
+  }
+}
+
+/* One call per draw. Returns the number of calls. */
+size_t render_queue_draw(
+    const struct roonium_render_queue *_queue,
+    const GLuint _shader)
+{
+  const GLint model_location = glGetUniformLocation(_shader, "u_model");
+  const GLint alpha_location = glGetUniformLocation(_shader, "u_alpha");
+  const GLint texture_rect_location =
+      glGetUniformLocation(_shader, "u_texture_rect");
+  const GLint texture_layer_location =
+      glGetUniformLocation(_shader, "u_texture_layer");
+  const struct roonium_render_item *item;
+  const struct roonium_texture_region *texture = NULL;
+  long i = 0;
+
+  while (i < _queue->count && i < _queue->capacity)
+  {
+    item = render_queue_item(_queue, i);
+    glUniformMatrix4fv(
+        model_location,
+        1,
+        GL_FALSE,
+        (const float *)&item->model);
+    glUniform1f(alpha_location, item->alpha);
+
+    if (item->texture != texture)
+    {
+      texture = item->texture;
+      glUniform4fv(texture_rect_location, 1, texture->rect);
+      glUniform1f(texture_layer_location, texture->layer);
+    }
+
+    draw_mesh_lod(*item->mesh, item->lod);
+    i++;
+  }
+
+  return (size_t)i;
+}
+
+/* Writes instances and draw commands of _queue to _stream and splits it
+ * in runs. _ordered keeps the queue order, so a non-indexed item after
+ * an indexed one starts a new run. Returns 0 on success, on failure
+ * _batch has no runs. */
+int render_queue_upload_indirect(
+    const struct roonium_render_queue *_queue,
+    struct roonium_indirect_batch *_batch,
+    struct roonium_stream *_stream,
+    struct roonium_arena *_arena,
+    const bool _ordered)
+{
+  const long count =
+      _queue->count < _queue->capacity ? _queue->count : _queue->capacity;
+  const struct roonium_render_item *item;
+  struct roonium_indirect_run *run = NULL;
+  struct roonium_draw_instance *instances;
+  struct roonium_draw_arrays_command *arrays = NULL;
+  struct roonium_draw_elements_command *elements = NULL;
+  size_t instances_first, arrays_offset = 0, elements_offset = 0;
+  size_t arrays_count = 0, elements_count = 0, j;
+  long i = 0;
+  bool indexed;
+
+  _batch->runs = NULL;
+  _batch->runs_count = 0;
+  if (count <= 0)
+    return 0;
+
+  _batch->runs = roonium_arena__alloc(
+      _arena,
+      count * sizeof(struct roonium_indirect_run));
+  if (!_batch->runs)
+    return 1;
+
+  /* Runs, with offsets counted in commands for now. */
+  while (i < count)
+  {
+    item = render_queue_item(_queue, i++);
+    indexed = item->mesh->lods_count != 0;
+    if (!run || (_ordered && !indexed && run->elements_count))
+    {
+      run = &_batch->runs[_batch->runs_count++];
+      run->arrays_offset = arrays_count;
+      run->arrays_count = 0;
+      run->elements_offset = elements_count;
+      run->elements_count = 0;
+    }
+
+    if (indexed)
+    {
+      run->elements_count++;
+      elements_count++;
+    }
+    else
+    {
+      run->arrays_count++;
+      arrays_count++;
+    }
+  }
+
+  /* Instances, addressed by base_instance from the start of the buffer. */
+  instances = roonium_stream__map(
+      _stream,
+      count * sizeof(struct roonium_draw_instance),
+      sizeof(struct roonium_draw_instance),
+      &instances_first);
+  if (!instances)
+  {
+    _batch->runs = NULL;
+    _batch->runs_count = 0;
+    return 1;
+  }
+  instances_first /= sizeof(struct roonium_draw_instance);
+
+  i = 0;
+  while (i < count)
+  {
+    item = render_queue_item(_queue, i);
+    memcpy(instances[i].model, item->model, sizeof(roonium_matrix));
+    memcpy(
+        instances[i].texture_rect,
+        item->texture->rect,
+        sizeof(instances[i].texture_rect));
+    instances[i].alpha = item->alpha;
+    instances[i].texture_layer = item->texture->layer;
+    i++;
+  }
+  roonium_stream__unmap(_stream);
+
+  if (arrays_count)
+  {
+    arrays = roonium_stream__map(
+        _stream,
+        arrays_count * sizeof(struct roonium_draw_arrays_command),
+        sizeof(GLuint),
+        &arrays_offset);
+    if (arrays)
+    {
+      i = 0;
+      while (i < count)
+      {
+        item = render_queue_item(_queue, i);
+        if (!item->mesh->lods_count)
+        {
+          arrays->count = item->mesh->vertices_count;
+          arrays->instance_count = 1;
+          arrays->first = item->mesh->vertices_first;
+          arrays->base_instance = instances_first + i;
+          arrays++;
+        }
+        i++;
+      }
+      roonium_stream__unmap(_stream);
+    }
+  }
+
+  if (elements_count)
+  {
+    elements = roonium_stream__map(
+        _stream,
+        elements_count * sizeof(struct roonium_draw_elements_command),
+        sizeof(GLuint),
+        &elements_offset);
+    if (elements)
+    {
+      i = 0;
+      while (i < count)
+      {
+        item = render_queue_item(_queue, i);
+        if (item->mesh->lods_count)
+        {
+          elements->count = item->mesh->lods[item->lod].indices_count;
+          elements->instance_count = 1;
+          elements->first_index = item->mesh->lods[item->lod].indices_first;
+          elements->base_vertex = (GLint)item->mesh->vertices_first;
+          elements->base_instance = instances_first + i;
+          elements++;
+        }
+        i++;
+      }
+      roonium_stream__unmap(_stream);
+    }
+  }
+
+  if ((arrays_count && !arrays) || (elements_count && !elements))
+  {
+    _batch->runs = NULL;
+    _batch->runs_count = 0;
+    return 1;
+  }
+
+  j = 0;
+  while (j < _batch->runs_count)
+  {
+    run = &_batch->runs[j++];
+    run->arrays_offset = arrays_offset +
+                         run->arrays_offset *
+                             sizeof(struct roonium_draw_arrays_command);
+    run->elements_offset = elements_offset +
+                           run->elements_offset *
+                               sizeof(struct roonium_draw_elements_command);
+  }
+
+  return 0;
+}
+
+/* Two calls per run, whatever the number of items. Returns the number
+ * of calls. */
+size_t render_queue_draw_indirect(
+    const struct roonium_indirect_batch *_batch,
+    const struct roonium_indirect *_indirect,
+    const struct roonium_geometry *_geometry,
+    const GLuint _buffer,
+    const GLuint _shader)
+{
+  const GLint indirect_location =
+      glGetUniformLocation(_shader, "u_indirect");
+  const struct roonium_indirect_run *run;
+  size_t i = 0, calls_count = 0;
+
+  glUniform1i(indirect_location, 1);
+  glBindVertexArray(_geometry->vao);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _buffer);
+
+  while (i < _batch->runs_count)
+  {
+    run = &_batch->runs[i++];
+    if (run->arrays_count)
+    {
+      _indirect->multi_draw_arrays(
+          GL_TRIANGLES,
+          (const GLvoid *)run->arrays_offset,
+          (GLsizei)run->arrays_count,
+          0);
+      calls_count++;
+    }
+    if (run->elements_count)
+    {
+      _indirect->multi_draw_elements(
+          GL_TRIANGLES,
+          GL_UNSIGNED_INT,
+          (const GLvoid *)run->elements_offset,
+          (GLsizei)run->elements_count,
+          0);
+      calls_count++;
+    }
+  }
+
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  glBindVertexArray(0);
+  glUniform1i(indirect_location, 0);
+
+  return calls_count;
+}
+
+void camera3d_get_projection(
+    roonium_matrix _destination,
+    const struct roonium_camera3d _camera)
+{
+  matrix_identity(_destination);
+  matrix_perspective(
+      _destination,
+      _camera.fov,
+      _camera.aspect,
+      ROONIUM_CAMERA_NEAR,
+      ROONIUM_CAMERA_FAR);
+}
+
+void camera3d_get_view(
+    roonium_matrix _destination,
+    const struct roonium_camera3d _camera)
+{
+  matrix_identity(_destination);
+  matrix_look_at(
+      _destination,
+      _camera.position,
+      _camera.target,
+      _camera.up);
+}
+
+/* Normalized planes of projection * view, pointing inside. */
+void camera3d_get_frustum(
+    roonium_vector4 _planes[6],
+    roonium_matrix _projection,
+    roonium_matrix _view)
+{
+  roonium_matrix clip;
+  float length;
+  int i = 0, row, sign;
+
+  matrix_multiply(clip, _projection, _view);
+
+  while (i < 6)
+  {
+    row = i / 2;
+    sign = i % 2 ? -1 : 1;
+    _planes[i].x = clip[0][3] + sign * clip[0][row];
+    _planes[i].y = clip[1][3] + sign * clip[1][row];
+    _planes[i].z = clip[2][3] + sign * clip[2][row];
+    _planes[i].w = clip[3][3] + sign * clip[3][row];
+
+    length = (float)sqrt(
+        _planes[i].x * _planes[i].x +
+        _planes[i].y * _planes[i].y +
+        _planes[i].z * _planes[i].z);
+    _planes[i].x /= length;
+    _planes[i].y /= length;
+    _planes[i].z /= length;
+    _planes[i].w /= length;
+    i++;
+  }
+}
+
+bool frustum_contains_sphere(
+    const roonium_vector4 _planes[6],
+    const roonium_vector3 _center,
+    const float _radius)
+{
+  int i = 0;
+
+  while (i < 6)
+  {
+    if (_planes[i].x * _center.x +
+            _planes[i].y * _center.y +
+            _planes[i].z * _center.z +
+            _planes[i].w <
+        -_radius)
+      return false;
+    i++;
+  }
+
+  return true;
+}
+
+GLuint load_shader_from_code(
+    const char *_vs_code,
+    const char *_fs_code)
+{
+  GLuint id, v_id, f_id;
+  int program_validate = 0;
+  char info[512];
+
+  v_id = glCreateShader(GL_VERTEX_SHADER);
+  glShaderSource(v_id, 1, &_vs_code, NULL);
+  glCompileShader(v_id);
+
+  f_id = glCreateShader(GL_FRAGMENT_SHADER);
+  glShaderSource(f_id, 1, &_fs_code, NULL);
+  glCompileShader(f_id);
+
+  id = glCreateProgram();
+  glAttachShader(id, v_id);
+  glAttachShader(id, f_id);
+  glLinkProgram(id);
+
+  glValidateProgram(id);
+  glGetProgramiv(id, GL_VALIDATE_STATUS, &program_validate);
+
+  if (!program_validate)
+  {
+    glGetProgramInfoLog(id, 512, NULL, info);
+    printf("Shader compilation error: %s\n", info);
+    glDeleteShader(v_id);
+    glDeleteShader(f_id);
+    glDeleteProgram(id);
+
+    id = (GLuint)-1;
+
+    return id;
+  };
+
+  glDeleteShader(v_id);
+  glDeleteShader(f_id);
+
+  return id;
+}
+
+/* Texture over the whole of _buffer, read with texelFetch. */
+GLuint create_buffer_texture(
+    const GLuint _buffer,
+    const GLenum _format)
+{
+  GLuint id;
+
+  glGenTextures(1, &id);
+  glBindTexture(GL_TEXTURE_BUFFER, id);
+  glTexBuffer(GL_TEXTURE_BUFFER, _format, _buffer);
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+  return id;
+}
+
+/* Returns 1 once per key press. */
+int roonium_app__key_pressed(
+    struct roonium_app *_app,
+    const int _key)
+{
+  const int state = glfwGetKey(_app->window, _key) == GLFW_PRESS;
+  const int pressed = state && !_app->keys[_key];
+
+  _app->keys[_key] = state;
+
+  return pressed;
+}
+
+void roonium_app__add_node(
+    struct roonium_app *_app,
+    struct roonium_scene_node *_node)
+{
+  _app->nodes[_app->nodes_count++] = _node;
+  if (_node->alpha < 1.0f)
+    _app->nodes_transparent_count++;
+}
+
+/* LOD: a grid of spheres running away from the camera.
+ * Swarm: a large field of small pyramids, mostly culled. */
+void roonium_app__set_benchmark_scene(
+    struct roonium_app *_app,
+    const enum roonium_benchmark_scene _scene)
+{
+  int side = 0, x, z;
+  struct roonium_scene_node *node;
+
+  while (_app->nodes_count > _app->nodes_base_count)
+  {
+    node = _app->nodes[--_app->nodes_count];
+    if (node->alpha < 1.0f)
+      _app->nodes_transparent_count--;
+    roonium_pool__release(&_app->scene_nodes, node);
+  }
+
+  _app->benchmark_scene = _scene;
+  if (_scene == ROONIUM_BENCHMARK_SCENE_LOD)
+    side = ROONIUM_LOD_BENCHMARK_SIDE;
+  else if (_scene == ROONIUM_BENCHMARK_SCENE_SWARM)
+    side = ROONIUM_SWARM_BENCHMARK_SIDE;
+
+  z = 0;
+  while (z < side)
+  {
+    x = 0;
+    while (x < side)
+    {
+      node = roonium_pool__alloc(&_app->scene_nodes);
+      if (!node)
+        return;
+      node->rotation_y = 0.0f;
+      node->alpha = 1.0f;
+      node->lod = 0;
+      node->texture = (x + z) % 2 ? _app->texture_icon : _app->texture;
+      if (_scene == ROONIUM_BENCHMARK_SCENE_LOD)
+      {
+        node->position.x = ((float)x - (float)(side - 1) / 2.0f) * 1.2f;
+        node->position.y = 0.0f;
+        node->position.z = -2.0f - (float)z * 2.5f;
+        node->rotation_speed = 0.5f;
+        node->mesh = _app->sphere;
+      }
+      else
+      {
+        node->position.x = ((float)x - (float)(side - 1) / 2.0f) * 0.6f;
+        node->position.y = -0.75f;
+        node->position.z = 2.0f - (float)z * 0.6f;
+        node->rotation_speed = (float)((x + z) % 7) - 3.0f;
+        node->mesh = _app->mesh_small;
+      }
+      roonium_app__add_node(_app, node);
+      x++;
+    }
+    z++;
+  }
+}
+
+static void roonium_frame__prepare_nodes(
+    void *_frame,
+    size_t _begin,
+    size_t _end)
+{
+  struct roonium_frame *frame = _frame;
+  struct roonium_scene_node *node;
+  struct roonium_render_item *item;
+  roonium_vector3 offset;
+  float depth;
+  long triangles_count = 0;
+
+  while (_begin < _end)
+  {
+    node = frame->nodes[_begin++];
+    node->rotation_y = frame->time * node->rotation_speed;
+
+    if (!frustum_contains_sphere(
+            frame->frustum,
+            node->position,
+            node->mesh->radius))
+      continue;
+
+    offset = vector3_subtract(node->position, frame->camera_position);
+    depth = vector3_length(offset);
+
+    /* Projected radius over half the screen height, that is the
+     * projected diameter over the full height. */
+    node->lod = frame->lod_enabled
+                    ? select_lod_level(
+                          node->lod,
+                          node->mesh->lods_count,
+                          node->mesh->radius * frame->projection[1][1] /
+                              (depth > 0.001f ? depth : 0.001f))
+                    : 0;
+
+    item = render_queue_push(
+        node->alpha < 1.0f
+            ? &frame->transparent
+            : &frame->opaque);
+    if (!item)
+      continue;
+
+    matrix_identity(item->model);
+    matrix_translate_in_place(
+        item->model,
+        node->position.x,
+        node->position.y,
+        node->position.z);
+    matrix_rotate_y(item->model, item->model, node->rotation_y);
+    item->mesh = node->mesh;
+    item->lod = node->lod;
+    item->texture = roonium_textures__get(frame->textures, node->texture);
+    item->alpha = node->alpha;
+    item->depth = depth;
+    triangles_count += (long)mesh_triangles_count(item->mesh, item->lod);
+  }
+
+  roonium_atomic__add(&frame->triangles_count, triangles_count);
+}
+
+/* Light 0 is the key light, the others circle the scene at different
+ * distances and heights. */
+static void roonium_frame__animate_lights(
+    struct roonium_frame *_frame)
+{
+  struct roonium_light *light;
+  float orbit, angle, hue;
+  size_t i = 1;
+
+  if (!_frame->lights_count)
+    return;
+
+  light = &_frame->lights[0];
+  light->position.x = 2.0f;
+  light->position.y = 1.0f;
+  light->position.z = 2.0f;
+  light->radius = 12.0f;
+  light->color.x = 0.9f;
+  light->color.y = 0.9f;
+  light->color.z = 0.9f;
+  light->intensity = 1.0f;
+
+  while (i < _frame->lights_count)
+  {
+    light = &_frame->lights[i];
+    orbit = 1.0f + (float)(i * 37 % 101) * 0.2f;
+    angle = _frame->time * (0.2f + (float)(i % 7) * 0.05f) +
+            (float)i * 2.4f;
+    hue = (float)i * 0.7f;
+
+    light->position.x = orbit * (float)cos(angle);
+    light->position.y = -0.5f + 0.4f * (float)sin(_frame->time + (float)i);
+    light->position.z = orbit * (float)sin(angle);
+    light->radius = 1.5f;
+    light->color.x = 0.5f + 0.5f * (float)cos(hue);
+    light->color.y = 0.5f + 0.5f * (float)cos(hue + 2.1f);
+    light->color.z = 0.5f + 0.5f * (float)cos(hue + 4.2f);
+    light->intensity = 1.0f;
+    i++;
+  }
+}
+
+/* Root job: transforms, culling, queues and light clusters in parallel,
+ * then sorting, in parallel chunks too. */
+static void roonium_frame__prepare(
+    void *_frame,
+    size_t _begin,
+    size_t _end)
+{
+  struct roonium_frame *frame = _frame;
+  struct roonium_job_counter counter = {0};
+  struct render_queue_sorter sorters[2];
+
+  UNUSED(_begin);
+  UNUSED(_end);
+
+  frame->prepare_start = glfwGetTime();
+  roonium_frame__animate_lights(frame);
+  roonium_jobs__parallel_for(
+      frame->jobs,
+      &counter,
+      roonium_frame__prepare_nodes,
+      frame,
+      frame->nodes_count,
+      ROONIUM_PREPARE_GRAIN);
+  if (frame->clusters.clusters)
+    roonium_jobs__parallel_for(
+        frame->jobs,
+        &counter,
+        roonium_clusters__count,
+        &frame->clusters,
+        ROONIUM_CLUSTERS_Z,
+        1);
+  roonium_jobs__join(frame->jobs, &counter);
+
+  /* Filling the clusters overlaps the sort, which joins both. */
+  if (frame->clusters.clusters)
+  {
+    roonium_clusters__offsets(&frame->clusters);
+    roonium_jobs__parallel_for(
+        frame->jobs,
+        &counter,
+        roonium_clusters__assign,
+        &frame->clusters,
+        ROONIUM_CLUSTERS_Z,
+        1);
+  }
+
+  render_queue_sorter__init(&sorters[0], &frame->opaque, true);
+  render_queue_sorter__init(&sorters[1], &frame->transparent, false);
+  render_queue_sort(frame->jobs, &counter, sorters, 2);
+
+  frame->prepare_time = glfwGetTime() - frame->prepare_start;
+}
+
+/* Starts preparing _frame on the workers and returns right away. */
+void roonium_app__prepare_frame(
+    struct roonium_app *_app,
+    struct roonium_frame *_frame)
+{
+  roonium_arena__reset(&_frame->arena);
+  render_queue_begin(
+      &_frame->opaque,
+      &_frame->arena,
+      _app->nodes_count - _app->nodes_transparent_count);
+  render_queue_begin(
+      &_frame->transparent,
+      &_frame->arena,
+      _app->nodes_transparent_count);
+  render_queue_begin(&_frame->streamed, &_frame->arena, 1);
+
+  camera3d_get_projection(_frame->projection, _app->camera);
+  camera3d_get_view(_frame->view, _app->camera);
+  camera3d_get_frustum(_frame->frustum, _frame->projection, _frame->view);
+  _frame->camera_position = _app->camera.position;
+  _frame->time = (float)_app->frames_time_now;
+  _frame->lod_enabled = _app->lod_enabled;
+  _frame->textures = &_app->textures;
+  _frame->lights = roonium_arena__alloc(
+      &_frame->arena,
+      _app->lights_count * sizeof(struct roonium_light));
+  _frame->lights_count = _frame->lights ? _app->lights_count : 0;
+  if (roonium_clusters__init(
+          &_frame->clusters,
+          &_frame->arena,
+          _frame->lights,
+          _frame->lights_count,
+          _frame->view,
+          _frame->projection,
+          ROONIUM_CAMERA_NEAR,
+          ROONIUM_CAMERA_FAR))
+    _frame->clusters.clusters = NULL;
+  _frame->nodes = _app->nodes;
+  _frame->nodes_count = _app->nodes_count;
+  _frame->jobs = _app->jobs;
+  _frame->triangles_count = 0;
+  _frame->prepared = true;
+
+  roonium_jobs__fork(
+      _app->jobs,
+      &_frame->counter,
+      roonium_frame__prepare,
+      _frame,
+      0,
+      0);
+}
+
+/* Streams a field of procedural pyramids through the ring buffer. */
+void roonium_app__stream_geometry(
+    struct roonium_app *_app)
+{
+  const int side = ROONIUM_STREAM_BENCHMARK_SIDE;
+  const float spacing = 0.3f;
+  const float time = (float)_app->frames_time_now;
+  roonium_vertex *vertices, *pyramid;
+  size_t offset;
+  float height;
+  int x, z, j;
+
+  _app->stream_mesh->vertices_count = 0;
+  vertices = roonium_stream__map(
+      &_app->stream,
+      side * side * ROONIUM_PYRAMID_VERTICES_COUNT * sizeof(roonium_vertex),
+      sizeof(roonium_vertex),
+      &offset);
+
+  if (!vertices)
+    return;
+
+  z = 0;
+  while (z < side)
+  {
+    x = 0;
+    while (x < side)
+    {
+      pyramid = vertices +
+                (z * side + x) * ROONIUM_PYRAMID_VERTICES_COUNT;
+      height = 0.2f + 0.15f * (float)sin(time * 2.0f + (x + z) * 0.4f);
+      build_pyramid_vertices(pyramid, 0.2f, height, 0.2f);
+
+      j = 0;
+      while (j < ROONIUM_PYRAMID_VERTICES_COUNT)
+      {
+        pyramid[j].position.x += (x - side / 2) * spacing;
+        pyramid[j].position.y += height / 2.0f - 1.0f;
+        pyramid[j].position.z += (z - side / 2) * spacing;
+        j++;
+      }
+      x++;
+    }
+    z++;
+  }
+
+  roonium_stream__unmap(&_app->stream);
+  _app->stream_mesh->vertices_first = offset / sizeof(roonium_vertex);
+  _app->stream_mesh->vertices_count =
+      side * side * ROONIUM_PYRAMID_VERTICES_COUNT;
+}
+
+/* Copies _size bytes to the lights stream, zeros if _data is NULL.
+ * Returns the offset in texels of _texel_size bytes. */
+size_t roonium_app__stream_lights_data(
+    struct roonium_app *_app,
+    const void *_data,
+    const size_t _size,
+    const size_t _texel_size)
+{
+  size_t offset = 0;
+  void *destination = roonium_stream__map(
+      &_app->lights_stream,
+      _size ? _size : _texel_size,
+      16,
+      &offset);
+
+  if (destination)
+  {
+    if (_data)
+      memcpy(destination, _data, _size);
+    else
+      memset(destination, 0, _size ? _size : _texel_size);
+    roonium_stream__unmap(&_app->lights_stream);
+  }
+
+  return offset / _texel_size;
+}
+
+/* Uploads the lights and clusters of _frame and points the shader at
+ * them. */
+void roonium_app__upload_lights(
+    struct roonium_app *_app,
+    const struct roonium_frame *_frame)
+{
+  const struct roonium_clusters *clusters = &_frame->clusters;
+  const bool clustered = clusters->clusters != NULL;
+  size_t lights_first, clusters_first, light_indices_first;
+
+  lights_first = roonium_app__stream_lights_data(
+      _app,
+      _frame->lights,
+      _frame->lights_count * sizeof(struct roonium_light),
+      2 * 4 * sizeof(float));
+  clusters_first = roonium_app__stream_lights_data(
+      _app,
+      clustered ? clusters->clusters : NULL,
+      ROONIUM_CLUSTERS_COUNT * sizeof(struct roonium_cluster),
+      sizeof(struct roonium_cluster));
+  light_indices_first = roonium_app__stream_lights_data(
+      _app,
+      clustered ? clusters->indices : NULL,
+      clustered
+          ? clusters->indices_count * sizeof(unsigned short)
+          : 0,
+      sizeof(unsigned short));
+
+  /* Lights are two RGBA32F texels each. */
+  glUniform1i(
+      glGetUniformLocation(_app->shader, "u_lights_first"),
+      (GLint)lights_first * 2);
+  glUniform1i(
+      glGetUniformLocation(_app->shader, "u_clusters_first"),
+      (GLint)clusters_first);
+  glUniform1i(
+      glGetUniformLocation(_app->shader, "u_light_indices_first"),
+      (GLint)light_indices_first);
+  glUniform3i(
+      glGetUniformLocation(_app->shader, "u_clusters_size"),
+      ROONIUM_CLUSTERS_X,
+      ROONIUM_CLUSTERS_Y,
+      ROONIUM_CLUSTERS_Z);
+  glUniform1f(
+      glGetUniformLocation(_app->shader, "u_clusters_near"),
+      ROONIUM_CAMERA_NEAR);
+  glUniform1f(
+      glGetUniformLocation(_app->shader, "u_clusters_depth_scale"),
+      clustered ? roonium_clusters__depth_scale(clusters) : 0.0f);
+  glUniform3f(
+      glGetUniformLocation(_app->shader, "u_ambient_color"),
+      _app->ambient_color.x,
+      _app->ambient_color.y,
+      _app->ambient_color.z);
+
+  glActiveTexture(GL_TEXTURE1);
+  glBindTexture(GL_TEXTURE_BUFFER, _app->lights_texture);
+  glActiveTexture(GL_TEXTURE2);
+  glBindTexture(GL_TEXTURE_BUFFER, _app->clusters_texture);
+  glActiveTexture(GL_TEXTURE3);
+  glBindTexture(GL_TEXTURE_BUFFER, _app->light_indices_texture);
+  glActiveTexture(GL_TEXTURE0);
+}
+
+/* Multi-draw indirect when _batch was uploaded, one call per draw
+ * otherwise. _shader is the bound program. */
+void roonium_app__draw_queue(
+    struct roonium_app *_app,
+    const struct roonium_render_queue *_queue,
+    const struct roonium_indirect_batch *_batch,
+    const GLuint _shader)
+{
+  if (_batch && _batch->runs)
+  {
+    _app->draw_calls_count += render_queue_draw_indirect(
+        _batch,
+        &_app->indirect,
+        &_app->geometry,
+        _app->indirect_stream.buffer,
+        _shader);
+    return;
+  }
+
+  _app->draw_calls_count += render_queue_draw(_queue, _shader);
+}
+
+void roonium_app__swap_buffers(
+    struct roonium_app *_app)
+{
+  roonium_stream__end_frame(&_app->stream);
+  roonium_stream__end_frame(&_app->lights_stream);
+  if (_app->indirect_supported)
+    roonium_stream__end_frame(&_app->indirect_stream);
+  roonium_resolution__end(&_app->resolution);
+  glfwSwapBuffers(_app->window);
+  _app->frame_time = glfwGetTime() - _app->frames_time_now;
+  _app->heap_allocations_frame =
+      roonium_memory__heap_stats()->allocations_count -
+      _app->heap_allocations_frame_start;
+  /* Set end drawing time. */
+  _app->frames_time_last = _app->frames_time_now;
+}
+
+void roonium_app__begin_frame(
+    struct roonium_app *_app)
+{
+  _app->frames_count++;
+  _app->frames_time_now = glfwGetTime();
+  if (_app->frames_time_now - _app->frames_time_last_fps > 1.0)
+  {
+    _app->stream_megabytes_per_second =
+        (double)(_app->stream.bytes_streamed -
+                 _app->stream_bytes_last_fps) /
+        (1024.0 * 1024.0) /
+        (_app->frames_time_now - _app->frames_time_last_fps);
+    _app->stream_bytes_last_fps = _app->stream.bytes_streamed;
+    _app->frames_time_last_fps = _app->frames_time_now;
+    _app->fps = _app->frames_count;
+    _app->frames_count = 0;
+  }
+
+  _app->heap_allocations_frame_start =
+      roonium_memory__heap_stats()->allocations_count;
+  roonium_stream__begin_frame(&_app->stream);
+  roonium_stream__begin_frame(&_app->lights_stream);
+  if (_app->indirect_supported)
+    roonium_stream__begin_frame(&_app->indirect_stream);
+  _app->draw_calls_count = 0;
+
+  glfwGetFramebufferSize(
+      _app->window,
+      &_app->settings.window_width,
+      &_app->settings.window_height);
+
+  _app->camera.aspect =
+      (float)_app->settings.window_width /
+      (float)_app->settings.window_height;
+
+  /* F8: scaled render target, sets the viewport. */
+  roonium_resolution__update(
+      &_app->resolution,
+      1.0 / (double)_app->settings.window_target_fps);
+  roonium_resolution__begin(
+      &_app->resolution,
+      _app->settings.window_width,
+      _app->settings.window_height);
+  glClearColor(0.9f, 0.9f, 0.9f, 1.0f);
+  glDepthMask(GL_TRUE);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  /* Draw.*/
+  glUseProgram(_app->shader);
+}
+
+int roonium_app__cull_frame(
+    struct roonium_app *_app)
+{
+  _app->frames_time_now = glfwGetTime();
+
+  if ((_app->frames_time_now - _app->frames_time_last) <=
+      (1.0 / (double)_app->settings.window_target_fps))
+  {
+    return 1;
+  }
+  return 0;
+}
+
+static void error_callback(int _error, const char *_description)
+{
+  UNUSED(_error);
+  fprintf(stderr, "Error: %s\n", _description);
+}
+
+int roonium_app__init(
+    struct roonium_app *_app)
+{
+  glfwSetErrorCallback(error_callback);
+  if (!glfwInit())
+  {
+    printf("Cannot initialize GLFW.\n");
+    return 1;
+  }
+  glfwWindowHint(GLFW_DEPTH_BITS, 16);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  /* Blits into a multisampled window are not allowed. */
+  glfwWindowHint(GLFW_SAMPLES, 0);
+
+  _app->settings.window_width = 800;
+  _app->settings.window_height = 600;
+  _app->settings.window_title = "Roonium";
+  _app->settings.window_target_fps = 60;
+  _app->frames_count = 0;
+  _app->frames_time_last_fps = 0.0;
+  _app->frames_time_last = 0.0;
+  _app->frames_time_now = 0.0;
+  _app->fps = _app->settings.window_target_fps;
+
+  _app->camera.position.x = 0.0f;
+  _app->camera.position.y = 1.0f;
+  _app->camera.position.z = 3.0f;
+  _app->camera.target.x = 0.0f;
+  _app->camera.target.y = 0.0f;
+  _app->camera.target.z = 0.0f;
+  _app->camera.up.x = 0.0f;
+  _app->camera.up.y = 1.0f;
+  _app->camera.up.z = 0.0f;
+  _app->camera.fov = 45.0f;
+  _app->camera.aspect = 800.0f / 600.0f;
+
+  _app->nodes_count = 0;
+  _app->nodes_transparent_count = 0;
+  _app->frame = 0;
+  _app->prepare_time = 0.0;
+  _app->heap_allocations_frame_start = 0;
+  _app->heap_allocations_frame = 0;
+  _app->stream_benchmark = false;
+  _app->depth_prepass = false;
+  _app->draw_calls_count = 0;
+  _app->indirect_supported = false;
+  _app->indirect_enabled = false;
+  _app->lights_count = ROONIUM_LIGHTS_COUNT;
+  _app->ambient_color.x = 0.36f;
+  _app->ambient_color.y = 0.36f;
+  _app->ambient_color.z = 0.36f;
+  _app->lod_enabled = true;
+  _app->benchmark_scene = ROONIUM_BENCHMARK_SCENE_NONE;
+  _app->nodes_base_count = 0;
+  _app->triangles_count = 0;
+  _app->frame_time = 0.0;
+  _app->stream_bytes_last_fps = 0;
+  _app->stream_megabytes_per_second = 0.0;
+  memset(_app->keys, 0, sizeof(_app->keys));
+  memset(_app->frames, 0, sizeof(_app->frames));
+  _app->nodes = malloc(
+      ROONIUM_SCENE_NODES_MAX * sizeof(struct roonium_scene_node *));
+  _app->jobs = roonium_jobs__create(0);
+  if (!_app->nodes ||
+      !_app->jobs ||
+      roonium_arena__init(&_app->frames[0].arena, ROONIUM_FRAME_ARENA_SIZE) ||
+      roonium_arena__init(&_app->frames[1].arena, ROONIUM_FRAME_ARENA_SIZE) ||
+      roonium_pool__init(
+          &_app->meshes,
+          sizeof(struct roonium_mesh),
+          ROONIUM_MESHES_MAX) ||
+      roonium_pool__init(
+          &_app->scene_nodes,
+          sizeof(struct roonium_scene_node),
+          ROONIUM_SCENE_NODES_MAX))
+  {
+    printf("Cannot allocate memory.\n");
+    return 1;
+  }
+  /* stb_image decodes into the first frame arena, used while loading. */
+  roonium_memory__bind_scratch(&_app->frames[0].arena);
+
+  return 0;
+}
+
+int roonium_app__run(
+    struct roonium_app *_app)
+{
+  char title[512];
+  GLFWimage window_icon;
+  struct roonium_scene_node *node;
+  struct roonium_render_item *item;
+  struct roonium_frame *frame;
+  unsigned int cluster_lights_max;
+  size_t i;
+
+  _app->window = glfwCreateWindow(
+      _app->settings.window_width,
+      _app->settings.window_height,
+      _app->settings.window_title,
+      NULL,
+      NULL);
+  _app->window_quit = false;
+
+  glfwMakeContextCurrent(_app->window);
+  gladLoadGL();
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_CULL_FACE);
+  glCullFace(GL_BACK);
+  glFrontFace(GL_CCW);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+  if (roonium_stream__init(
+          &_app->stream,
+          GL_ARRAY_BUFFER,
+          ROONIUM_STREAM_SIZE))
+  {
+    printf("Cannot create stream buffer.\n");
+    return 1;
+  }
+  if (roonium_stream__init(
+          &_app->lights_stream,
+          GL_TEXTURE_BUFFER,
+          ROONIUM_LIGHTS_STREAM_SIZE))
+  {
+    printf("Cannot create lights buffer.\n");
+    return 1;
+  }
+  _app->lights_texture = create_buffer_texture(
+      _app->lights_stream.buffer,
+      GL_RGBA32F);
+  _app->clusters_texture = create_buffer_texture(
+      _app->lights_stream.buffer,
+      GL_RG32UI);
+  _app->light_indices_texture = create_buffer_texture(
+      _app->lights_stream.buffer,
+      GL_R16UI);
+
+  /* Static meshes share one VAO. Per-draw data for multi-draw indirect
+   * comes from instanced attributes in the indirect stream. */
+  if (roonium_geometry__init(
+          &_app->geometry,
+          sizeof(roonium_vertex),
+          ROONIUM_GEOMETRY_VERTICES_MAX,
+          ROONIUM_GEOMETRY_INDICES_MAX))
+  {
+    printf("Cannot create geometry buffers.\n");
+    return 1;
+  }
+  _app->indirect_supported = roonium_indirect__init(&_app->indirect);
+  if (_app->indirect_supported &&
+      roonium_stream__init(
+          &_app->indirect_stream,
+          GL_DRAW_INDIRECT_BUFFER,
+          ROONIUM_INDIRECT_STREAM_SIZE))
+  {
+    /* The buffer is created before the error shows up. */
+    roonium_stream__free(&_app->indirect_stream);
+    _app->indirect_supported = false;
+  }
+  _app->indirect_enabled = _app->indirect_supported;
+  if (roonium_resolution__init(&_app->resolution))
+    _app->resolution.enabled = false;
+  glBindVertexArray(_app->geometry.vao);
+  glBindBuffer(GL_ARRAY_BUFFER, _app->geometry.vbo);
+  set_vertex_attributes();
+  if (_app->indirect_supported)
+    roonium_indirect__set_instance_attributes(_app->indirect_stream.buffer);
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  _app->stream_mesh = roonium_pool__alloc(&_app->meshes);
+  memset(_app->stream_mesh, 0, sizeof(*_app->stream_mesh));
+  glGenVertexArrays(1, &_app->stream_mesh->vao);
+  glBindVertexArray(_app->stream_mesh->vao);
+  glBindBuffer(GL_ARRAY_BUFFER, _app->stream.buffer);
+  set_vertex_attributes();
+  glBindVertexArray(0);
+
+  _app->mesh = roonium_pool__alloc(&_app->meshes);
+  *_app->mesh = generate_mesh_pyramid(
+      &_app->geometry,
+      &_app->frames[0].arena,
+      1.25f,
+      1.0f,
+      1.25f);
+  _app->shader = load_shader_from_code(
+      (const char *)RESOURCES_SHADER_VS,
+      (const char *)RESOURCES_SHADER_FS);
+  glUseProgram(_app->shader);
+  glUniform1i(glGetUniformLocation(_app->shader, "texture0"), 0);
+  glUniform1i(glGetUniformLocation(_app->shader, "u_lights"), 1);
+  glUniform1i(glGetUniformLocation(_app->shader, "u_clusters"), 2);
+  glUniform1i(glGetUniformLocation(_app->shader, "u_light_indices"), 3);
+  _app->depth_shader = load_shader_from_code(
+      (const char *)RESOURCES_DEPTH_VS,
+      (const char *)RESOURCES_DEPTH_FS);
+  glUseProgram(0);
+  _app->mesh_small = roonium_pool__alloc(&_app->meshes);
+  *_app->mesh_small = generate_mesh_pyramid(
+      &_app->geometry,
+      &_app->frames[0].arena,
+      0.25f,
+      0.2f,
+      0.25f);
+  _app->sphere = roonium_pool__alloc(&_app->meshes);
+  *_app->sphere = generate_mesh_lod_sphere(
+      &_app->geometry,
+      &_app->frames[0].arena,
+      0.5f,
+      0.08f,
+      64,
+      128);
+  roonium_arena__reset(&_app->frames[0].arena);
+  if (roonium_textures__init(&_app->textures))
+    return 1;
+  _app->texture = roonium_textures__load_from_memory(
+      &_app->textures,
+      &_app->frames[0].arena,
+      RESOURCES_ROON_JPG,
+      RESOURCES_ROON_JPG_SIZE);
+
+  /* Set icon, it is a texture as well. */
+  {
+    window_icon.pixels = stbi_load_from_memory(
+        RESOURCES_ROON_ICON_PNG,
+        RESOURCES_ROON_ICON_PNG_SIZE,
+        &window_icon.width,
+        &window_icon.height,
+        0,
+        4);
+
+    if (window_icon.pixels)
+    {
+      glfwSetWindowIcon(
+          _app->window,
+          1,
+          &window_icon);
+      _app->texture_icon = roonium_textures__add(
+          &_app->textures,
+          &_app->frames[0].arena,
+          window_icon.pixels,
+          window_icon.width,
+          window_icon.height);
+    }
+    else
+    {
+      _app->texture_icon = ROONIUM_TEXTURE_INVALID;
+    }
+
+    window_icon.width = 0;
+    window_icon.height = 0;
+    roonium_memory__free(window_icon.pixels);
+  }
+  roonium_textures__generate_mipmaps(&_app->textures);
+
+  /* Scene: the pyramid and a ring of smaller ones, every other one
+   * transparent, in pairs wearing the icon. */
+  {
+    node = roonium_pool__alloc(&_app->scene_nodes);
+    node->position.x = 0.0f;
+    node->position.y = 0.0f;
+    node->position.z = 0.0f;
+    node->rotation_y = 0.0f;
+    node->rotation_speed = 3.0f;
+    node->alpha = 1.0f;
+    node->mesh = _app->mesh;
+    node->lod = 0;
+    node->texture = _app->texture;
+    roonium_app__add_node(_app, node);
+
+    i = 0;
+    while (i < 8)
+    {
+      node = roonium_pool__alloc(&_app->scene_nodes);
+      node->position.x = 1.5f * (float)cos(i * M_PI / 4.0);
+      node->position.y = -0.25f;
+      node->position.z = 1.5f * (float)sin(i * M_PI / 4.0);
+      node->rotation_y = 0.0f;
+      node->rotation_speed = -1.0f;
+      node->alpha = i % 2 ? 0.5f : 1.0f;
+      node->mesh = _app->mesh;
+      node->lod = 0;
+      node->texture = i % 4 < 2 ? _app->texture : _app->texture_icon;
+      roonium_app__add_node(_app, node);
+      i++;
+    }
+    _app->nodes_base_count = _app->nodes_count;
+  }
+
+  /* Loading leftovers. */
+  roonium_arena__reset(&_app->frames[0].arena);
+
+  while (!_app->window_quit)
+  {
+    /* Fixed FPS. */
+    if (roonium_app__cull_frame(_app))
+    {
+      continue;
+    }
+
+    /* Wait for the frame prepared during the previous submission. */
+    frame = &_app->frames[_app->frame];
+    if (!frame->prepared)
+      roonium_app__prepare_frame(_app, frame);
+    roonium_jobs__join(_app->jobs, &frame->counter);
+    frame->prepared = false;
+    _app->triangles_count = (size_t)frame->triangles_count;
+    _app->prepare_time = frame->prepare_time;
+
+    /* Events. Workers are idle, the scene can change. */
+    {
+      glfwPollEvents();
+      _app->window_quit |= glfwWindowShouldClose(_app->window);
+      _app->window_quit |= glfwGetKey(_app->window, GLFW_KEY_ESCAPE);
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F1))
+        _app->stream_benchmark = !_app->stream_benchmark;
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F2))
+        _app->depth_prepass = !_app->depth_prepass;
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F3))
+        roonium_app__set_benchmark_scene(
+            _app,
+            _app->benchmark_scene == ROONIUM_BENCHMARK_SCENE_LOD
+                ? ROONIUM_BENCHMARK_SCENE_NONE
+                : ROONIUM_BENCHMARK_SCENE_LOD);
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F4))
+        _app->lod_enabled = !_app->lod_enabled;
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F5))
+        roonium_app__set_benchmark_scene(
+            _app,
+            _app->benchmark_scene == ROONIUM_BENCHMARK_SCENE_SWARM
+                ? ROONIUM_BENCHMARK_SCENE_NONE
+                : ROONIUM_BENCHMARK_SCENE_SWARM);
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F7))
+        _app->indirect_enabled =
+            _app->indirect_supported && !_app->indirect_enabled;
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F8))
+        _app->resolution.enabled = !_app->resolution.enabled;
+      if (roonium_app__key_pressed(_app, GLFW_KEY_F6))
+        _app->lights_count = _app->lights_count * 4 > ROONIUM_LIGHTS_MAX
+                                 ? 16
+                                 : _app->lights_count * 4;
+
+      cluster_lights_max = 0;
+      i = 0;
+      while (i < ROONIUM_CLUSTERS_Z)
+      {
+        if (frame->clusters.slice_lights_max[i] > cluster_lights_max)
+          cluster_lights_max = frame->clusters.slice_lights_max[i];
+        i++;
+      }
+
+      sprintf(
+          title,
+          "Roonium; FPS: %i; Frame: %.2f ms; Prepare: %.2f ms x%u; "
+          "Heap allocs/frame: %u; Arena peak: %u KB; Stream: %.1f MB/s; "
+          "Triangles: %u; LOD: %s; "
+          "Lights: %u (%u indices, %u dropped, max %u/cluster); "
+          "Draw calls: %u; MDI: %s; GPU: %.2f ms; "
+          "Resolution: %ix%i (%.0f%%, %s)",
+          _app->fps,
+          _app->frame_time * 1000.0,
+          _app->prepare_time * 1000.0,
+          (unsigned int)roonium_jobs__threads_count(_app->jobs),
+          (unsigned int)_app->heap_allocations_frame,
+          (unsigned int)(frame->arena.stats.bytes_peak / 1024),
+          _app->stream_megabytes_per_second,
+          (unsigned int)_app->triangles_count,
+          _app->lod_enabled ? "on" : "off",
+          (unsigned int)frame->lights_count,
+          (unsigned int)frame->clusters.indices_count,
+          (unsigned int)frame->clusters.indices_dropped,
+          cluster_lights_max,
+          (unsigned int)_app->draw_calls_count,
+          _app->indirect_supported
+              ? (_app->indirect_enabled ? "on" : "off")
+              : "unsupported",
+          _app->resolution.gpu_time * 1000.0,
+          _app->resolution.render_width,
+          _app->resolution.render_height,
+          _app->resolution.scale * 100.0f,
+          _app->resolution.enabled ? "dynamic" : "fixed");
+
+      glfwSetWindowTitle(_app->window, title);
+    }
+
+    roonium_app__begin_frame(_app);
+
+    /* F1: streamed geometry benchmark. */
+    if (_app->stream_benchmark)
+    {
+      roonium_app__stream_geometry(_app);
+      item = render_queue_push(&frame->streamed);
+      if (item)
+      {
+        matrix_identity(item->model);
+        item->mesh = _app->stream_mesh;
+        item->lod = 0;
+        item->texture = roonium_textures__get(&_app->textures, _app->texture);
+        item->alpha = 1.0f;
+        item->depth = 0.0f;
+        _app->triangles_count +=
+            mesh_triangles_count(item->mesh, item->lod);
+      }
+    }
+
+    /* Overlap: the next frame is simulated while this one is submitted. */
+    roonium_app__prepare_frame(
+        _app,
+        &_app->frames[(_app->frame + 1) % ROONIUM_FRAMES_PREPARED]);
+
+    /* Set shader uniforms. */
+    {
+      glUniformMatrix4fv(
+          glGetUniformLocation(
+              _app->shader,
+              "u_projection"),
+          1,
+          GL_FALSE,
+          (const float *)&frame->projection);
+      glUniformMatrix4fv(
+          glGetUniformLocation(_app->shader, "u_view"),
+          1,
+          GL_FALSE,
+          (const float *)&frame->view);
+      /* Clusters split the render target, not the window. */
+      glUniform2f(
+          glGetUniformLocation(_app->shader, "u_screen_size"),
+          (float)_app->resolution.render_width,
+          (float)_app->resolution.render_height);
+      roonium_app__upload_lights(_app, frame);
+
+      if (_app->depth_prepass)
+      {
+        glUseProgram(_app->depth_shader);
+        glUniformMatrix4fv(
+            glGetUniformLocation(_app->depth_shader, "u_projection"),
+            1,
+            GL_FALSE,
+            (const float *)&frame->projection);
+        glUniformMatrix4fv(
+            glGetUniformLocation(_app->depth_shader, "u_view"),
+            1,
+            GL_FALSE,
+            (const float *)&frame->view);
+      }
+    }
+
+    /* Drawing */
+    {
+      glUseProgram(_app->shader);
+
+      /* Every image is in the array, a single bind for all passes. */
+      glBindTexture(GL_TEXTURE_2D_ARRAY, _app->textures.id);
+
+      /* F7: a couple of multi-draws per pass instead of one call per
+       * draw. */
+      if (_app->indirect_enabled)
+      {
+        render_queue_upload_indirect(
+            &frame->opaque,
+            &frame->opaque_batch,
+            &_app->indirect_stream,
+            &frame->arena,
+            false);
+        render_queue_upload_indirect(
+            &frame->transparent,
+            &frame->transparent_batch,
+            &_app->indirect_stream,
+            &frame->arena,
+            true);
+      }
+      else
+      {
+        frame->opaque_batch.runs = NULL;
+        frame->transparent_batch.runs = NULL;
+      }
+
+      /* F2: depth prepass with the depth-only program, opaque pass
+       * then only shades visible fragments. */
+      if (_app->depth_prepass)
+      {
+        glUseProgram(_app->depth_shader);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_TRUE);
+        glDepthFunc(GL_LESS);
+        roonium_app__draw_queue(
+            _app,
+            &frame->opaque,
+            &frame->opaque_batch,
+            _app->depth_shader);
+        roonium_app__draw_queue(
+            _app,
+            &frame->streamed,
+            NULL,
+            _app->depth_shader);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glUseProgram(_app->shader);
+      }
+
+      /* Opaque. */
+      glDisable(GL_BLEND);
+      glDepthMask(_app->depth_prepass ? GL_FALSE : GL_TRUE);
+      glDepthFunc(_app->depth_prepass ? GL_LEQUAL : GL_LESS);
+      roonium_app__draw_queue(
+          _app,
+          &frame->opaque,
+          &frame->opaque_batch,
+          _app->shader);
+      roonium_app__draw_queue(_app, &frame->streamed, NULL, _app->shader);
+
+      /* Transparent. */
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      glDepthMask(GL_FALSE);
+      glDepthFunc(GL_LESS);
+      roonium_app__draw_queue(
+          _app,
+          &frame->transparent,
+          &frame->transparent_batch,
+          _app->shader);
+      glDepthMask(GL_TRUE);
+
+      roonium_app__swap_buffers(_app);
+    }
+
+    _app->frame = (_app->frame + 1) % ROONIUM_FRAMES_PREPARED;
+  }
+
+  /* Let the workers finish before the scene goes away. */
+  roonium_jobs__join(_app->jobs, &_app->frames[_app->frame].counter);
+
+  return 0;
+}
+
+void roonium_app__quit(
+    struct roonium_app *_app)
+{
+
+  glUseProgram(0);
+  glDisableVertexAttribArray(0);
+  glDisableVertexAttribArray(1);
+  glDeleteProgram(_app->shader);
+  glDeleteProgram(_app->depth_shader);
+  roonium_geometry__free(&_app->geometry);
+  if (_app->indirect_supported)
+    roonium_stream__free(&_app->indirect_stream);
+  roonium_textures__free(&_app->textures);
+  roonium_resolution__free(&_app->resolution);
+  glDeleteVertexArrays(1, &_app->stream_mesh->vao);
+  roonium_stream__free(&_app->stream);
+  glDeleteTextures(1, &_app->lights_texture);
+  glDeleteTextures(1, &_app->clusters_texture);
+  glDeleteTextures(1, &_app->light_indices_texture);
+  roonium_stream__free(&_app->lights_stream);
+  glfwDestroyWindow(_app->window);
+  glfwTerminate();
+
+  roonium_jobs__destroy(_app->jobs);
+  roonium_memory__bind_scratch(NULL);
+  roonium_pool__free(&_app->scene_nodes);
+  roonium_pool__free(&_app->meshes);
+  roonium_arena__free(&_app->frames[0].arena);
+  roonium_arena__free(&_app->frames[1].arena);
+  free(_app->nodes);
+}
+
+int main()
+{
+  struct roonium_app app;
+
+  if (roonium_app__init(&app) ||
+      roonium_app__run(&app))
+    return 1;
+
+  roonium_app__quit(&app);
+
+  return 0;
+}
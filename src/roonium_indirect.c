@@ -0,0 +1,167 @@
+#include <string.h>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "roonium_indirect.h"
+
+int roonium_geometry__init(
+    struct roonium_geometry *_geometry,
+    const size_t _vertex_size,
+    const size_t _vertices_capacity,
+    const size_t _indices_capacity)
+{
+  memset(_geometry, 0, sizeof(*_geometry));
+  _geometry->vertex_size = _vertex_size;
+  _geometry->vertices_capacity = _vertices_capacity;
+  _geometry->indices_capacity = _indices_capacity;
+
+  glGenVertexArrays(1, &_geometry->vao);
+  glBindVertexArray(_geometry->vao);
+  glGenBuffers(1, &_geometry->vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, _geometry->vbo);
+  glBufferData(
+      GL_ARRAY_BUFFER,
+      _vertices_capacity * _vertex_size,
+      NULL,
+      GL_STATIC_DRAW);
+  glGenBuffers(1, &_geometry->ebo);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _geometry->ebo);
+  glBufferData(
+      GL_ELEMENT_ARRAY_BUFFER,
+      _indices_capacity * sizeof(unsigned int),
+      NULL,
+      GL_STATIC_DRAW);
+  glBindVertexArray(0);
+
+  return glGetError() != GL_NO_ERROR;
+}
+
+int roonium_geometry__append(
+    struct roonium_geometry *_geometry,
+    const void *_vertices,
+    const size_t _vertices_count,
+    const unsigned int *_indices,
+    const size_t _indices_count,
+    size_t *_vertices_first,
+    size_t *_indices_first)
+{
+  if (_geometry->vertices_count + _vertices_count >
+          _geometry->vertices_capacity ||
+      _geometry->indices_count + _indices_count >
+          _geometry->indices_capacity)
+    return 1;
+
+  glBindBuffer(GL_ARRAY_BUFFER, _geometry->vbo);
+  glBufferSubData(
+      GL_ARRAY_BUFFER,
+      _geometry->vertices_count * _geometry->vertex_size,
+      _vertices_count * _geometry->vertex_size,
+      _vertices);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  if (_indices && _indices_count)
+  {
+    /* Leave the element binding of the VAO alone. */
+    glBindVertexArray(0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _geometry->ebo);
+    glBufferSubData(
+        GL_COPY_WRITE_BUFFER,
+        _geometry->indices_count * sizeof(unsigned int),
+        _indices_count * sizeof(unsigned int),
+        _indices);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+  *_vertices_first = _geometry->vertices_count;
+  *_indices_first = _geometry->indices_count;
+  _geometry->vertices_count += _vertices_count;
+  _geometry->indices_count += _indices ? _indices_count : 0;
+
+  return 0;
+}
+
+void roonium_geometry__free(
+    struct roonium_geometry *_geometry)
+{
+  glDeleteBuffers(1, &_geometry->vbo);
+  glDeleteBuffers(1, &_geometry->ebo);
+  glDeleteVertexArrays(1, &_geometry->vao);
+  memset(_geometry, 0, sizeof(*_geometry));
+}
+
+bool roonium_indirect__init(
+    struct roonium_indirect *_indirect)
+{
+  GLint major = 0, minor = 0;
+
+  memset(_indirect, 0, sizeof(*_indirect));
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+  /* base_instance in the commands needs ARB_base_instance too. */
+  if ((major > 4 || (major == 4 && minor >= 3)) ||
+      (glfwExtensionSupported("GL_ARB_multi_draw_indirect") &&
+       glfwExtensionSupported("GL_ARB_base_instance")))
+  {
+    _indirect->multi_draw_arrays =
+        (roonium_multi_draw_arrays_indirect_proc)glfwGetProcAddress(
+            "glMultiDrawArraysIndirect");
+    _indirect->multi_draw_elements =
+        (roonium_multi_draw_elements_indirect_proc)glfwGetProcAddress(
+            "glMultiDrawElementsIndirect");
+  }
+
+  if (!_indirect->multi_draw_arrays || !_indirect->multi_draw_elements)
+  {
+    _indirect->multi_draw_arrays = NULL;
+    _indirect->multi_draw_elements = NULL;
+    return false;
+  }
+
+  return true;
+}
+
+void roonium_indirect__set_instance_attributes(
+    const GLuint _buffer)
+{
+  GLuint i = 0;
+
+  glBindBuffer(GL_ARRAY_BUFFER, _buffer);
+
+  /* A mat4 takes four vec4 slots. */
+  while (i < 4)
+  {
+    glEnableVertexAttribArray(ROONIUM_INSTANCE_ATTRIBUTE_MODEL + i);
+    glVertexAttribPointer(
+        ROONIUM_INSTANCE_ATTRIBUTE_MODEL + i,
+        4,
+        GL_FLOAT,
+        GL_FALSE,
+        sizeof(struct roonium_draw_instance),
+        (GLvoid *)(offsetof(struct roonium_draw_instance, model) +
+                   i * 4 * sizeof(float)));
+    glVertexAttribDivisor(ROONIUM_INSTANCE_ATTRIBUTE_MODEL + i, 1);
+    i++;
+  }
+
+  glEnableVertexAttribArray(ROONIUM_INSTANCE_ATTRIBUTE_TEXTURE_RECT);
+  glVertexAttribPointer(
+      ROONIUM_INSTANCE_ATTRIBUTE_TEXTURE_RECT,
+      4,
+      GL_FLOAT,
+      GL_FALSE,
+      sizeof(struct roonium_draw_instance),
+      (GLvoid *)offsetof(struct roonium_draw_instance, texture_rect));
+  glVertexAttribDivisor(ROONIUM_INSTANCE_ATTRIBUTE_TEXTURE_RECT, 1);
+
+  /* alpha and texture_layer are adjacent. */
+  glEnableVertexAttribArray(ROONIUM_INSTANCE_ATTRIBUTE_ALPHA_LAYER);
+  glVertexAttribPointer(
+      ROONIUM_INSTANCE_ATTRIBUTE_ALPHA_LAYER,
+      2,
+      GL_FLOAT,
+      GL_FALSE,
+      sizeof(struct roonium_draw_instance),
+      (GLvoid *)offsetof(struct roonium_draw_instance, alpha));
+  glVertexAttribDivisor(ROONIUM_INSTANCE_ATTRIBUTE_ALPHA_LAYER, 1);
+}
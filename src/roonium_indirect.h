@@ -0,0 +1,109 @@
+#ifndef ROONIUM_INDIRECT_H
+#define ROONIUM_INDIRECT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <glad/glad.h>
+#include <roonmath.h>
+
+/* Multi-draw indirect is not part of the GL 3.3 loader. */
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+/* Per-draw data of multi-draw indirect, in vertex attributes 3 to 8. */
+#define ROONIUM_INSTANCE_ATTRIBUTE_MODEL 3
+#define ROONIUM_INSTANCE_ATTRIBUTE_TEXTURE_RECT 7
+#define ROONIUM_INSTANCE_ATTRIBUTE_ALPHA_LAYER 8
+
+/* Vertices and indices of every static mesh. Meshes keep their offsets,
+ * so one VAO and one multi-draw cover them all. */
+typedef struct roonium_geometry
+{
+  GLuint vao, vbo, ebo;
+  size_t vertices_count;
+  size_t vertices_capacity;
+  size_t vertex_size;
+  size_t indices_count;
+  size_t indices_capacity;
+} roonium_geometry;
+
+/* Layout fixed by GL. */
+typedef struct roonium_draw_arrays_command
+{
+  GLuint count;
+  GLuint instance_count;
+  GLuint first;
+  GLuint base_instance;
+} roonium_draw_arrays_command;
+
+typedef struct roonium_draw_elements_command
+{
+  GLuint count;
+  GLuint instance_count;
+  GLuint first_index;
+  GLint base_vertex;
+  GLuint base_instance;
+} roonium_draw_elements_command;
+
+/* Read by the vertex shader through base_instance. */
+typedef struct roonium_draw_instance
+{
+  roonium_matrix model;
+  float texture_rect[4];
+  float alpha;
+  float texture_layer;
+  float padding[2];
+} roonium_draw_instance;
+
+typedef void(APIENTRYP roonium_multi_draw_arrays_indirect_proc)(
+    GLenum _mode,
+    const void *_indirect,
+    GLsizei _draw_count,
+    GLsizei _stride);
+
+typedef void(APIENTRYP roonium_multi_draw_elements_indirect_proc)(
+    GLenum _mode,
+    GLenum _type,
+    const void *_indirect,
+    GLsizei _draw_count,
+    GLsizei _stride);
+
+/* glMultiDraw*Indirect, from GL 4.3 or ARB_multi_draw_indirect with
+ * ARB_base_instance. Both are NULL on plain GL 3.3. */
+typedef struct roonium_indirect
+{
+  roonium_multi_draw_arrays_indirect_proc multi_draw_arrays;
+  roonium_multi_draw_elements_indirect_proc multi_draw_elements;
+} roonium_indirect;
+
+/* Returns 0 on success. */
+int roonium_geometry__init(
+    struct roonium_geometry *_geometry,
+    const size_t _vertex_size,
+    const size_t _vertices_capacity,
+    const size_t _indices_capacity);
+
+/* Copies a mesh in. _indices may be NULL. _vertices_first and
+ * _indices_first receive where it landed. Returns 0 on success. */
+int roonium_geometry__append(
+    struct roonium_geometry *_geometry,
+    const void *_vertices,
+    const size_t _vertices_count,
+    const unsigned int *_indices,
+    const size_t _indices_count,
+    size_t *_vertices_first,
+    size_t *_indices_first);
+
+void roonium_geometry__free(
+    struct roonium_geometry *_geometry);
+
+/* Loads the entry points. Returns true if multi-draw indirect works. */
+bool roonium_indirect__init(
+    struct roonium_indirect *_indirect);
+
+/* Points the instance attributes of the bound VAO at _buffer, one
+ * roonium_draw_instance per instance from offset 0. */
+void roonium_indirect__set_instance_attributes(
+    const GLuint _buffer);
+#endif
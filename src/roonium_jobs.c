@@ -0,0 +1,463 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "roonium_jobs.h"
+
+/* Platform. */
+#ifdef _WIN32
+typedef CRITICAL_SECTION roonium_mutex;
+typedef CONDITION_VARIABLE roonium_condition;
+typedef HANDLE roonium_thread;
+typedef DWORD roonium_thread_key;
+#define roonium_mutex__init(_m) InitializeCriticalSection(_m)
+#define roonium_mutex__free(_m) DeleteCriticalSection(_m)
+#define roonium_mutex__lock(_m) EnterCriticalSection(_m)
+#define roonium_mutex__unlock(_m) LeaveCriticalSection(_m)
+#define roonium_condition__init(_c) InitializeConditionVariable(_c)
+#define roonium_condition__free(_c) ((void)(_c))
+#define roonium_condition__wait(_c, _m) SleepConditionVariableCS(_c, _m, INFINITE)
+#define roonium_condition__wake_all(_c) WakeAllConditionVariable(_c)
+#define roonium_thread__yield() SwitchToThread()
+#else
+typedef pthread_mutex_t roonium_mutex;
+typedef pthread_cond_t roonium_condition;
+typedef pthread_t roonium_thread;
+typedef pthread_key_t roonium_thread_key;
+#define roonium_mutex__init(_m) pthread_mutex_init(_m, NULL)
+#define roonium_mutex__free(_m) pthread_mutex_destroy(_m)
+#define roonium_mutex__lock(_m) pthread_mutex_lock(_m)
+#define roonium_mutex__unlock(_m) pthread_mutex_unlock(_m)
+#define roonium_condition__init(_c) pthread_cond_init(_c, NULL)
+#define roonium_condition__free(_c) pthread_cond_destroy(_c)
+#define roonium_condition__wait(_c, _m) pthread_cond_wait(_c, _m)
+#define roonium_condition__wake_all(_c) pthread_cond_broadcast(_c)
+#define roonium_thread__yield() sched_yield()
+#endif
+
+typedef struct roonium_job_deque
+{
+  roonium_mutex mutex;
+  size_t top;
+  size_t bottom;
+  struct roonium_job jobs[ROONIUM_JOBS_DEQUE_SIZE];
+} roonium_job_deque;
+
+typedef struct roonium_job_worker
+{
+  struct roonium_jobs *jobs;
+  size_t index;
+  roonium_thread thread;
+} roonium_job_worker;
+
+struct roonium_jobs
+{
+  size_t threads_count;
+  struct roonium_job_deque *deques;
+  struct roonium_job_worker *workers;
+  roonium_thread_key thread_key;
+
+  /* Sleeping workers. */
+  roonium_mutex sleep_mutex;
+  roonium_condition sleep_condition;
+  volatile long queued;
+  volatile long quit;
+};
+
+long roonium_atomic__add(
+    volatile long *_target,
+    const long _value)
+{
+#ifdef _WIN32
+  return InterlockedExchangeAdd(_target, _value) + _value;
+#else
+  return __sync_add_and_fetch(_target, _value);
+#endif
+}
+
+/* Index of the calling thread, 0 for the creator. */
+static size_t roonium_jobs__thread_index(
+    struct roonium_jobs *_jobs)
+{
+#ifdef _WIN32
+  return (size_t)TlsGetValue(_jobs->thread_key);
+#else
+  return (size_t)pthread_getspecific(_jobs->thread_key);
+#endif
+}
+
+static void roonium_jobs__set_thread_index(
+    struct roonium_jobs *_jobs,
+    const size_t _index)
+{
+#ifdef _WIN32
+  TlsSetValue(_jobs->thread_key, (LPVOID)_index);
+#else
+  pthread_setspecific(_jobs->thread_key, (void *)_index);
+#endif
+}
+
+static int roonium_job_deque__push(
+    struct roonium_job_deque *_deque,
+    const struct roonium_job *_job)
+{
+  int pushed = 0;
+
+  roonium_mutex__lock(&_deque->mutex);
+  if (_deque->bottom - _deque->top < ROONIUM_JOBS_DEQUE_SIZE)
+  {
+    _deque->jobs[_deque->bottom % ROONIUM_JOBS_DEQUE_SIZE] = *_job;
+    _deque->bottom++;
+    pushed = 1;
+  }
+  roonium_mutex__unlock(&_deque->mutex);
+
+  return pushed;
+}
+
+/* Owner end: newest job first, its data is still in cache. */
+static int roonium_job_deque__pop(
+    struct roonium_job_deque *_deque,
+    struct roonium_job *_job)
+{
+  int popped = 0;
+
+  roonium_mutex__lock(&_deque->mutex);
+  if (_deque->bottom != _deque->top)
+  {
+    _deque->bottom--;
+    *_job = _deque->jobs[_deque->bottom % ROONIUM_JOBS_DEQUE_SIZE];
+    popped = 1;
+  }
+  roonium_mutex__unlock(&_deque->mutex);
+
+  return popped;
+}
+
+/* Thief end: oldest job first. */
+static int roonium_job_deque__steal(
+    struct roonium_job_deque *_deque,
+    struct roonium_job *_job)
+{
+  int stolen = 0;
+
+  roonium_mutex__lock(&_deque->mutex);
+  if (_deque->bottom != _deque->top)
+  {
+    *_job = _deque->jobs[_deque->top % ROONIUM_JOBS_DEQUE_SIZE];
+    _deque->top++;
+    stolen = 1;
+  }
+  roonium_mutex__unlock(&_deque->mutex);
+
+  return stolen;
+}
+
+static int roonium_jobs__find(
+    struct roonium_jobs *_jobs,
+    const size_t _index,
+    struct roonium_job *_job)
+{
+  size_t i = 1;
+
+  if (!roonium_job_deque__pop(&_jobs->deques[_index], _job))
+  {
+    while (i < _jobs->threads_count)
+    {
+      if (roonium_job_deque__steal(
+              &_jobs->deques[(_index + i) % _jobs->threads_count],
+              _job))
+        break;
+      i++;
+    }
+
+    if (i == _jobs->threads_count)
+      return 0;
+  }
+
+  roonium_atomic__add(&_jobs->queued, -1);
+
+  return 1;
+}
+
+static void roonium_jobs__execute(
+    const struct roonium_job *_job)
+{
+  _job->function(_job->data, _job->begin, _job->end);
+  roonium_atomic__add(&_job->counter->pending, -1);
+}
+
+static void roonium_jobs__worker_loop(
+    struct roonium_job_worker *_worker)
+{
+  struct roonium_jobs *jobs = _worker->jobs;
+  struct roonium_job job;
+
+  roonium_jobs__set_thread_index(jobs, _worker->index);
+
+  while (!roonium_atomic__add(&jobs->quit, 0))
+  {
+    if (roonium_jobs__find(jobs, _worker->index, &job))
+    {
+      roonium_jobs__execute(&job);
+      continue;
+    }
+
+    roonium_mutex__lock(&jobs->sleep_mutex);
+    while (!roonium_atomic__add(&jobs->quit, 0) &&
+           roonium_atomic__add(&jobs->queued, 0) <= 0)
+      roonium_condition__wait(&jobs->sleep_condition, &jobs->sleep_mutex);
+    roonium_mutex__unlock(&jobs->sleep_mutex);
+  }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI roonium_jobs__worker(
+    LPVOID _worker)
+{
+  roonium_jobs__worker_loop(_worker);
+  return 0;
+}
+#else
+static void *roonium_jobs__worker(
+    void *_worker)
+{
+  roonium_jobs__worker_loop(_worker);
+  return NULL;
+}
+#endif
+
+static size_t roonium_jobs__cores_count(void)
+{
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return (size_t)info.dwNumberOfProcessors;
+#else
+  const long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t)count : 1;
+#endif
+}
+
+struct roonium_jobs *roonium_jobs__create(
+    size_t _threads_count)
+{
+  struct roonium_jobs *jobs;
+  size_t i = 0;
+
+  if (!_threads_count)
+    _threads_count = roonium_jobs__cores_count();
+  if (_threads_count > ROONIUM_JOBS_THREADS_MAX)
+    _threads_count = ROONIUM_JOBS_THREADS_MAX;
+
+  jobs = malloc(sizeof(*jobs));
+  if (!jobs)
+    return NULL;
+
+  memset(jobs, 0, sizeof(*jobs));
+  jobs->threads_count = _threads_count;
+  jobs->deques = malloc(_threads_count * sizeof(*jobs->deques));
+  jobs->workers = malloc(_threads_count * sizeof(*jobs->workers));
+  if (!jobs->deques || !jobs->workers)
+  {
+    free(jobs->deques);
+    free(jobs->workers);
+    free(jobs);
+    return NULL;
+  }
+
+#ifdef _WIN32
+  jobs->thread_key = TlsAlloc();
+#else
+  pthread_key_create(&jobs->thread_key, NULL);
+#endif
+  roonium_jobs__set_thread_index(jobs, 0);
+  roonium_mutex__init(&jobs->sleep_mutex);
+  roonium_condition__init(&jobs->sleep_condition);
+
+  while (i < _threads_count)
+  {
+    roonium_mutex__init(&jobs->deques[i].mutex);
+    jobs->deques[i].top = 0;
+    jobs->deques[i].bottom = 0;
+    jobs->workers[i].jobs = jobs;
+    jobs->workers[i].index = i;
+    i++;
+  }
+
+  /* Thread 0 is the caller. */
+  i = 1;
+  while (i < _threads_count)
+  {
+#ifdef _WIN32
+    jobs->workers[i].thread = CreateThread(
+        NULL,
+        0,
+        roonium_jobs__worker,
+        &jobs->workers[i],
+        0,
+        NULL);
+#else
+    pthread_create(
+        &jobs->workers[i].thread,
+        NULL,
+        roonium_jobs__worker,
+        &jobs->workers[i]);
+#endif
+    i++;
+  }
+
+  return jobs;
+}
+
+void roonium_jobs__destroy(
+    struct roonium_jobs *_jobs)
+{
+  size_t i = 1;
+
+  if (!_jobs)
+    return;
+
+  roonium_mutex__lock(&_jobs->sleep_mutex);
+  roonium_atomic__add(&_jobs->quit, 1);
+  roonium_condition__wake_all(&_jobs->sleep_condition);
+  roonium_mutex__unlock(&_jobs->sleep_mutex);
+
+  while (i < _jobs->threads_count)
+  {
+#ifdef _WIN32
+    WaitForSingleObject(_jobs->workers[i].thread, INFINITE);
+    CloseHandle(_jobs->workers[i].thread);
+#else
+    pthread_join(_jobs->workers[i].thread, NULL);
+#endif
+    i++;
+  }
+
+  i = 0;
+  while (i < _jobs->threads_count)
+  {
+    roonium_mutex__free(&_jobs->deques[i].mutex);
+    i++;
+  }
+
+  roonium_condition__free(&_jobs->sleep_condition);
+  roonium_mutex__free(&_jobs->sleep_mutex);
+#ifdef _WIN32
+  TlsFree(_jobs->thread_key);
+#else
+  pthread_key_delete(_jobs->thread_key);
+#endif
+  free(_jobs->deques);
+  free(_jobs->workers);
+  free(_jobs);
+}
+
+size_t roonium_jobs__threads_count(
+    const struct roonium_jobs *_jobs)
+{
+  return _jobs->threads_count;
+}
+
+static void roonium_jobs__wake(
+    struct roonium_jobs *_jobs)
+{
+  roonium_mutex__lock(&_jobs->sleep_mutex);
+  roonium_condition__wake_all(&_jobs->sleep_condition);
+  roonium_mutex__unlock(&_jobs->sleep_mutex);
+}
+
+/* Returns 0 if the job had to run inline. */
+static int roonium_jobs__push(
+    struct roonium_jobs *_jobs,
+    const struct roonium_job *_job)
+{
+  roonium_atomic__add(&_job->counter->pending, 1);
+  roonium_atomic__add(&_jobs->queued, 1);
+
+  if (roonium_job_deque__push(
+          &_jobs->deques[roonium_jobs__thread_index(_jobs)],
+          _job))
+    return 1;
+
+  roonium_atomic__add(&_jobs->queued, -1);
+  roonium_jobs__execute(_job);
+
+  return 0;
+}
+
+void roonium_jobs__fork(
+    struct roonium_jobs *_jobs,
+    struct roonium_job_counter *_counter,
+    roonium_job_function _function,
+    void *_data,
+    const size_t _begin,
+    const size_t _end)
+{
+  struct roonium_job job;
+
+  job.function = _function;
+  job.data = _data;
+  job.begin = _begin;
+  job.end = _end;
+  job.counter = _counter;
+
+  if (roonium_jobs__push(_jobs, &job) && _jobs->threads_count > 1)
+    roonium_jobs__wake(_jobs);
+}
+
+void roonium_jobs__parallel_for(
+    struct roonium_jobs *_jobs,
+    struct roonium_job_counter *_counter,
+    roonium_job_function _function,
+    void *_data,
+    const size_t _count,
+    const size_t _grain)
+{
+  const size_t grain = _grain ? _grain : 1;
+  struct roonium_job job;
+  size_t begin = 0;
+
+  job.function = _function;
+  job.data = _data;
+  job.counter = _counter;
+
+  while (begin < _count)
+  {
+    job.begin = begin;
+    job.end = _count - begin > grain ? begin + grain : _count;
+    roonium_jobs__push(_jobs, &job);
+    begin = job.end;
+  }
+
+  if (_jobs->threads_count > 1)
+    roonium_jobs__wake(_jobs);
+}
+
+void roonium_jobs__join(
+    struct roonium_jobs *_jobs,
+    struct roonium_job_counter *_counter)
+{
+  const size_t index = roonium_jobs__thread_index(_jobs);
+  struct roonium_job job;
+
+  /* The atomic read also orders the results of the finished jobs. */
+  while (roonium_atomic__add(&_counter->pending, 0) > 0)
+  {
+    if (roonium_jobs__find(_jobs, index, &job))
+      roonium_jobs__execute(&job);
+    else
+      roonium_thread__yield();
+  }
+}
@@ -0,0 +1,78 @@
+#ifndef ROONIUM_JOBS_H
+#define ROONIUM_JOBS_H
+
+#include <stddef.h>
+
+/* Jobs each thread can keep queued. A full deque runs jobs inline. */
+#ifndef ROONIUM_JOBS_DEQUE_SIZE
+#define ROONIUM_JOBS_DEQUE_SIZE 4096
+#endif
+
+#ifndef ROONIUM_JOBS_THREADS_MAX
+#define ROONIUM_JOBS_THREADS_MAX 64
+#endif
+
+/* Runs the job on [_begin, _end). */
+typedef void (*roonium_job_function)(
+    void *_data,
+    size_t _begin,
+    size_t _end);
+
+/* Fork/join counter. Zero when every job forked on it is done. */
+typedef struct roonium_job_counter
+{
+  volatile long pending;
+} roonium_job_counter;
+
+typedef struct roonium_job
+{
+  roonium_job_function function;
+  void *data;
+  size_t begin;
+  size_t end;
+  struct roonium_job_counter *counter;
+} roonium_job;
+
+/* Work-stealing scheduler. Every thread owns a deque: it pushes and pops
+ * at the bottom, idle threads steal from the top of the others. The
+ * thread that creates it is thread 0 and works while it joins. */
+typedef struct roonium_jobs roonium_jobs;
+
+/* _threads_count counts the calling thread; 0 uses every core. */
+struct roonium_jobs *roonium_jobs__create(
+    size_t _threads_count);
+
+void roonium_jobs__destroy(
+    struct roonium_jobs *_jobs);
+
+size_t roonium_jobs__threads_count(
+    const struct roonium_jobs *_jobs);
+
+/* Queues one job on the deque of the calling thread. */
+void roonium_jobs__fork(
+    struct roonium_jobs *_jobs,
+    struct roonium_job_counter *_counter,
+    roonium_job_function _function,
+    void *_data,
+    const size_t _begin,
+    const size_t _end);
+
+/* Splits [0, _count) into jobs of _grain items. */
+void roonium_jobs__parallel_for(
+    struct roonium_jobs *_jobs,
+    struct roonium_job_counter *_counter,
+    roonium_job_function _function,
+    void *_data,
+    const size_t _count,
+    const size_t _grain);
+
+/* Runs queued jobs until _counter drops to zero. */
+void roonium_jobs__join(
+    struct roonium_jobs *_jobs,
+    struct roonium_job_counter *_counter);
+
+/* Atomically adds _value and returns the new value. */
+long roonium_atomic__add(
+    volatile long *_target,
+    const long _value);
+#endif
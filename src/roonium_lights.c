@@ -0,0 +1,274 @@
+#include <string.h>
+#include <math.h>
+
+#include "roonium_lights.h"
+
+#define ROONIUM_CLUSTERS_TILES (ROONIUM_CLUSTERS_X * ROONIUM_CLUSTERS_Y)
+
+int roonium_clusters__init(
+    struct roonium_clusters *_clusters,
+    struct roonium_arena *_arena,
+    const struct roonium_light *_lights,
+    const size_t _lights_count,
+    roonium_matrix _view,
+    roonium_matrix _projection,
+    const float _near,
+    const float _far)
+{
+  const size_t lights_count =
+      _lights_count < ROONIUM_LIGHTS_MAX ? _lights_count : ROONIUM_LIGHTS_MAX;
+
+  memset(_clusters, 0, sizeof(*_clusters));
+  /* No more than every light in every cluster. */
+  _clusters->indices_capacity =
+      lights_count * ROONIUM_CLUSTERS_COUNT < ROONIUM_CLUSTERS_INDICES_MAX
+          ? lights_count * ROONIUM_CLUSTERS_COUNT
+          : ROONIUM_CLUSTERS_INDICES_MAX;
+  _clusters->clusters = roonium_arena__alloc(
+      _arena,
+      ROONIUM_CLUSTERS_COUNT * sizeof(struct roonium_cluster));
+  _clusters->indices = roonium_arena__alloc(
+      _arena,
+      _clusters->indices_capacity * sizeof(unsigned short));
+  _clusters->slice_lights = roonium_arena__alloc(
+      _arena,
+      ROONIUM_CLUSTERS_Z * lights_count * sizeof(unsigned short));
+  _clusters->slice_ranges = roonium_arena__alloc(
+      _arena,
+      ROONIUM_CLUSTERS_Z * lights_count * sizeof(*_clusters->slice_ranges));
+
+  if (!_clusters->clusters || !_clusters->indices ||
+      !_clusters->slice_lights || !_clusters->slice_ranges)
+    return 1;
+
+  _clusters->lights = _lights;
+  _clusters->lights_count = lights_count;
+  memcpy(_clusters->view, _view, sizeof(roonium_matrix));
+  _clusters->projection_x = _projection[0][0];
+  _clusters->projection_y = _projection[1][1];
+  _clusters->near = _near;
+  _clusters->far = _far;
+
+  return 0;
+}
+
+float roonium_clusters__depth_scale(
+    const struct roonium_clusters *_clusters)
+{
+  return (float)(ROONIUM_CLUSTERS_Z /
+                 log(_clusters->far / _clusters->near));
+}
+
+/* Tiles covered by [_center - _radius, _center + _radius] seen anywhere
+ * between depths _near and _far. Each edge is projected from the depth
+ * that pushes it outwards. Returns 0 when the interval is off screen. */
+static int roonium_clusters__tiles(
+    const float _center,
+    const float _radius,
+    const float _near,
+    const float _far,
+    const float _scale,
+    const int _tiles,
+    unsigned char *_first,
+    unsigned char *_last)
+{
+  const float low = _center - _radius;
+  const float high = _center + _radius;
+  const float ndc_low = low * _scale / (low < 0.0f ? _near : _far);
+  const float ndc_high = high * _scale / (high > 0.0f ? _near : _far);
+  int first, last;
+
+  if (ndc_high < -1.0f || ndc_low > 1.0f)
+    return 0;
+
+  first = (int)floor((ndc_low * 0.5f + 0.5f) * _tiles);
+  last = (int)floor((ndc_high * 0.5f + 0.5f) * _tiles);
+  first = first < 0 ? 0 : (first >= _tiles ? _tiles - 1 : first);
+  last = last < 0 ? 0 : (last >= _tiles ? _tiles - 1 : last);
+  *_first = (unsigned char)first;
+  *_last = (unsigned char)last;
+
+  return 1;
+}
+
+/* Lights overlapping slice _z, their tile rectangles and the number
+ * of lights of every cluster. */
+static void roonium_clusters__count_slice(
+    struct roonium_clusters *_clusters,
+    const size_t _z)
+{
+  unsigned short *lights =
+      _clusters->slice_lights + _z * _clusters->lights_count;
+  unsigned char(*ranges)[4] =
+      _clusters->slice_ranges + _z * _clusters->lights_count;
+  struct roonium_cluster *slice =
+      _clusters->clusters + _z * ROONIUM_CLUSTERS_TILES;
+  const struct roonium_light *light;
+  const float ratio = _clusters->far / _clusters->near;
+  const float slice_near =
+      _clusters->near * (float)pow(ratio, (double)_z / ROONIUM_CLUSTERS_Z);
+  const float slice_far =
+      _clusters->near * (float)pow(ratio, (double)(_z + 1) / ROONIUM_CLUSTERS_Z);
+  roonium_vector3 center;
+  float depth, near, far;
+  size_t i = 0, lights_count = 0;
+  unsigned int x, y, tile;
+
+  tile = 0;
+  while (tile < ROONIUM_CLUSTERS_TILES)
+    slice[tile++].count = 0;
+
+  while (i < _clusters->lights_count)
+  {
+    light = &_clusters->lights[i];
+    center.x = _clusters->view[0][0] * light->position.x +
+               _clusters->view[1][0] * light->position.y +
+               _clusters->view[2][0] * light->position.z +
+               _clusters->view[3][0];
+    center.y = _clusters->view[0][1] * light->position.x +
+               _clusters->view[1][1] * light->position.y +
+               _clusters->view[2][1] * light->position.z +
+               _clusters->view[3][1];
+    center.z = _clusters->view[0][2] * light->position.x +
+               _clusters->view[1][2] * light->position.y +
+               _clusters->view[2][2] * light->position.z +
+               _clusters->view[3][2];
+    depth = -center.z;
+
+    if (depth + light->radius < slice_near ||
+        depth - light->radius > slice_far)
+    {
+      i++;
+      continue;
+    }
+
+    near = depth - light->radius > slice_near ? depth - light->radius : slice_near;
+    far = depth + light->radius < slice_far ? depth + light->radius : slice_far;
+
+    if (roonium_clusters__tiles(
+            center.x,
+            light->radius,
+            near,
+            far,
+            _clusters->projection_x,
+            ROONIUM_CLUSTERS_X,
+            &ranges[lights_count][0],
+            &ranges[lights_count][1]) &&
+        roonium_clusters__tiles(
+            center.y,
+            light->radius,
+            near,
+            far,
+            _clusters->projection_y,
+            ROONIUM_CLUSTERS_Y,
+            &ranges[lights_count][2],
+            &ranges[lights_count][3]))
+    {
+      y = ranges[lights_count][2];
+      while (y <= ranges[lights_count][3])
+      {
+        x = ranges[lights_count][0];
+        while (x <= ranges[lights_count][1])
+        {
+          slice[y * ROONIUM_CLUSTERS_X + x].count++;
+          x++;
+        }
+        y++;
+      }
+      lights[lights_count++] = (unsigned short)i;
+    }
+    i++;
+  }
+  _clusters->slice_lights_count[_z] = (unsigned int)lights_count;
+
+  _clusters->slice_lights_max[_z] = 0;
+  tile = 0;
+  while (tile < ROONIUM_CLUSTERS_TILES)
+  {
+    if (slice[tile].count > _clusters->slice_lights_max[_z])
+      _clusters->slice_lights_max[_z] = slice[tile].count;
+    tile++;
+  }
+}
+
+void roonium_clusters__count(
+    void *_clusters,
+    size_t _begin,
+    size_t _end)
+{
+  while (_begin < _end)
+  {
+    roonium_clusters__count_slice(_clusters, _begin);
+    _begin++;
+  }
+}
+
+void roonium_clusters__offsets(
+    struct roonium_clusters *_clusters)
+{
+  struct roonium_cluster *cluster = _clusters->clusters;
+  size_t available = _clusters->indices_capacity, i = 0;
+
+  _clusters->indices_dropped = 0;
+  while (i < ROONIUM_CLUSTERS_COUNT)
+  {
+    if (cluster->count > available)
+    {
+      _clusters->indices_dropped += cluster->count - available;
+      cluster->count = (unsigned int)available;
+    }
+    cluster->first = (unsigned int)(_clusters->indices_capacity - available);
+    available -= cluster->count;
+    cluster++;
+    i++;
+  }
+  _clusters->indices_count = _clusters->indices_capacity - available;
+}
+
+/* Writes the lights of slice _z into the ranges of its clusters. */
+static void roonium_clusters__assign_slice(
+    struct roonium_clusters *_clusters,
+    const size_t _z)
+{
+  const unsigned short *lights =
+      _clusters->slice_lights + _z * _clusters->lights_count;
+  const unsigned char(*ranges)[4] =
+      (const unsigned char(*)[4])_clusters->slice_ranges +
+      _z * _clusters->lights_count;
+  const struct roonium_cluster *slice =
+      _clusters->clusters + _z * ROONIUM_CLUSTERS_TILES;
+  unsigned int filled[ROONIUM_CLUSTERS_TILES];
+  size_t i = 0;
+  unsigned int x, y, tile;
+
+  memset(filled, 0, sizeof(filled));
+  while (i < _clusters->slice_lights_count[_z])
+  {
+    y = ranges[i][2];
+    while (y <= ranges[i][3])
+    {
+      x = ranges[i][0];
+      while (x <= ranges[i][1])
+      {
+        tile = y * ROONIUM_CLUSTERS_X + x;
+        if (filled[tile] < slice[tile].count)
+          _clusters->indices[slice[tile].first + filled[tile]++] = lights[i];
+        x++;
+      }
+      y++;
+    }
+    i++;
+  }
+}
+
+void roonium_clusters__assign(
+    void *_clusters,
+    size_t _begin,
+    size_t _end)
+{
+  while (_begin < _end)
+  {
+    roonium_clusters__assign_slice(_clusters, _begin);
+    _begin++;
+  }
+}
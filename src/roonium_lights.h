@@ -0,0 +1,113 @@
+#ifndef ROONIUM_LIGHTS_H
+#define ROONIUM_LIGHTS_H
+
+#include <stddef.h>
+#include <roonmath.h>
+
+#include "roonium_memory.h"
+
+/* Cluster grid: screen tiles times exponential depth slices. */
+#ifndef ROONIUM_CLUSTERS_X
+#define ROONIUM_CLUSTERS_X 16
+#endif
+#ifndef ROONIUM_CLUSTERS_Y
+#define ROONIUM_CLUSTERS_Y 9
+#endif
+#ifndef ROONIUM_CLUSTERS_Z
+#define ROONIUM_CLUSTERS_Z 24
+#endif
+#define ROONIUM_CLUSTERS_COUNT \
+  (ROONIUM_CLUSTERS_X * ROONIUM_CLUSTERS_Y * ROONIUM_CLUSTERS_Z)
+
+/* Light indices are 16 bit. */
+#ifndef ROONIUM_LIGHTS_MAX
+#define ROONIUM_LIGHTS_MAX 1024
+#endif
+
+/* Light indices of a frame, all clusters together. Clusters get their
+ * share in order; indices past it are dropped and counted. */
+#ifndef ROONIUM_CLUSTERS_INDICES_MAX
+#define ROONIUM_CLUSTERS_INDICES_MAX (128 * 1024)
+#endif
+
+/* Point light. Same layout as the two RGBA32F texels the shader reads. */
+typedef struct roonium_light
+{
+  roonium_vector3 position;
+  float radius;
+  roonium_vector3 color;
+  float intensity;
+} roonium_light;
+
+/* Range of a cluster in the light index list. RG32UI texel. */
+typedef struct roonium_cluster
+{
+  unsigned int first;
+  unsigned int count;
+} roonium_cluster;
+
+/* Lights of one frame sorted into clusters.
+ * Clusters go x first, then y, then z. Slice z covers view depths
+ * near * (far / near) ^ (z / ROONIUM_CLUSTERS_Z) up to the next one. */
+typedef struct roonium_clusters
+{
+  struct roonium_cluster *clusters;
+  unsigned short *indices;
+  size_t indices_capacity;
+
+  /* Lights touching each slice and their tile rectangles, lights_count
+   * entries per slice. */
+  unsigned short *slice_lights;
+  unsigned char (*slice_ranges)[4];
+  unsigned int slice_lights_count[ROONIUM_CLUSTERS_Z];
+  const struct roonium_light *lights;
+  size_t lights_count;
+  roonium_matrix view;
+  float projection_x;
+  float projection_y;
+  float near;
+  float far;
+
+  /* Stats. Slices write their own entry, the offsets the totals. */
+  unsigned int slice_lights_max[ROONIUM_CLUSTERS_Z];
+  size_t indices_count;
+  size_t indices_dropped;
+} roonium_clusters;
+
+/* Allocates the grid in _arena. _lights must outlive it.
+ * Returns 0 on success. */
+int roonium_clusters__init(
+    struct roonium_clusters *_clusters,
+    struct roonium_arena *_arena,
+    const struct roonium_light *_lights,
+    const size_t _lights_count,
+    roonium_matrix _view,
+    roonium_matrix _projection,
+    const float _near,
+    const float _far);
+
+/* Finds the lights of slices [_begin, _end) and counts them per cluster.
+ * Slices are independent, so this runs as a roonium_job_function on a
+ * struct roonium_clusters. */
+void roonium_clusters__count(
+    void *_clusters,
+    size_t _begin,
+    size_t _end);
+
+/* Prefix sum of the counts into index ranges, once every slice is
+ * counted. Counts past the capacity are cut and added to
+ * indices_dropped. */
+void roonium_clusters__offsets(
+    struct roonium_clusters *_clusters);
+
+/* Fills the index ranges of slices [_begin, _end), once the offsets are
+ * set. Runs as a roonium_job_function too. */
+void roonium_clusters__assign(
+    void *_clusters,
+    size_t _begin,
+    size_t _end);
+
+/* Multiplier turning log(depth / near) into a slice index. */
+float roonium_clusters__depth_scale(
+    const struct roonium_clusters *_clusters);
+#endif
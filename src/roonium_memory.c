@@ -0,0 +1,247 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "roonium_memory.h"
+
+#define ROONIUM_MEMORY_ALIGN(_size)         \
+  (((_size) + ROONIUM_MEMORY_ALIGNMENT - 1) & \
+   ~(size_t)(ROONIUM_MEMORY_ALIGNMENT - 1))
+
+/* Header in front of every block handed out by the heap hook. */
+typedef struct roonium_memory_header
+{
+  size_t size;
+  size_t from_arena;
+} roonium_memory_header;
+
+#define ROONIUM_MEMORY_HEADER_SIZE \
+  ROONIUM_MEMORY_ALIGN(sizeof(struct roonium_memory_header))
+
+static struct roonium_arena *roonium_memory_scratch = NULL;
+static struct roonium_memory_stats roonium_memory_heap = {0, 0, 0};
+
+static void roonium_memory_stats__add(
+    struct roonium_memory_stats *_stats,
+    const size_t _size)
+{
+  _stats->bytes_used += _size;
+  _stats->allocations_count++;
+  if (_stats->bytes_used > _stats->bytes_peak)
+    _stats->bytes_peak = _stats->bytes_used;
+}
+
+int roonium_arena__init(
+    struct roonium_arena *_arena,
+    const size_t _capacity)
+{
+  memset(_arena, 0, sizeof(*_arena));
+  _arena->capacity = ROONIUM_MEMORY_ALIGN(_capacity);
+  _arena->data = malloc(_arena->capacity);
+
+  if (!_arena->data)
+  {
+    _arena->capacity = 0;
+    return 1;
+  }
+
+  return 0;
+}
+
+void *roonium_arena__alloc(
+    struct roonium_arena *_arena,
+    const size_t _size)
+{
+  const size_t size = ROONIUM_MEMORY_ALIGN(_size);
+  void *result;
+
+  if (size > _arena->capacity - _arena->offset)
+    return NULL;
+
+  result = _arena->data + _arena->offset;
+  _arena->offset_last = _arena->offset;
+  _arena->offset += size;
+  roonium_memory_stats__add(&_arena->stats, size);
+
+  return result;
+}
+
+void roonium_arena__reset(
+    struct roonium_arena *_arena)
+{
+  _arena->offset = 0;
+  _arena->offset_last = 0;
+  _arena->stats.bytes_used = 0;
+}
+
+void roonium_arena__free(
+    struct roonium_arena *_arena)
+{
+  if (roonium_memory_scratch == _arena)
+    roonium_memory_scratch = NULL;
+
+  free(_arena->data);
+  memset(_arena, 0, sizeof(*_arena));
+}
+
+int roonium_pool__init(
+    struct roonium_pool *_pool,
+    const size_t _element_size,
+    const size_t _capacity)
+{
+  size_t i = 0;
+
+  memset(_pool, 0, sizeof(*_pool));
+  _pool->element_size = ROONIUM_MEMORY_ALIGN(
+      _element_size < sizeof(void *) ? sizeof(void *) : _element_size);
+  _pool->capacity = _capacity;
+  _pool->data = malloc(_pool->element_size * _pool->capacity);
+
+  if (!_pool->data)
+  {
+    _pool->capacity = 0;
+    return 1;
+  }
+
+  /* Thread every element into the free list. */
+  while (i < _pool->capacity)
+  {
+    roonium_pool__release(_pool, _pool->data + i * _pool->element_size);
+    i++;
+  }
+  _pool->stats.bytes_used = 0;
+
+  return 0;
+}
+
+void *roonium_pool__alloc(
+    struct roonium_pool *_pool)
+{
+  void *result = _pool->free_list;
+
+  if (!result)
+    return NULL;
+
+  _pool->free_list = *(void **)result;
+  roonium_memory_stats__add(&_pool->stats, _pool->element_size);
+
+  return result;
+}
+
+void roonium_pool__release(
+    struct roonium_pool *_pool,
+    void *_element)
+{
+  if (!_element)
+    return;
+
+  *(void **)_element = _pool->free_list;
+  _pool->free_list = _element;
+  if (_pool->stats.bytes_used >= _pool->element_size)
+    _pool->stats.bytes_used -= _pool->element_size;
+}
+
+void roonium_pool__free(
+    struct roonium_pool *_pool)
+{
+  free(_pool->data);
+  memset(_pool, 0, sizeof(*_pool));
+}
+
+void roonium_memory__bind_scratch(
+    struct roonium_arena *_arena)
+{
+  roonium_memory_scratch = _arena;
+}
+
+void *roonium_memory__malloc(
+    const size_t _size)
+{
+  struct roonium_memory_header *header = NULL;
+  const size_t size = ROONIUM_MEMORY_HEADER_SIZE + _size;
+
+  if (roonium_memory_scratch)
+  {
+    header = roonium_arena__alloc(roonium_memory_scratch, size);
+    if (header)
+      header->from_arena = 1;
+  }
+
+  /* No scratch arena or it ran out. */
+  if (!header)
+  {
+    header = malloc(size);
+    if (!header)
+      return NULL;
+    header->from_arena = 0;
+    roonium_memory_stats__add(&roonium_memory_heap, _size);
+  }
+
+  header->size = _size;
+
+  return (unsigned char *)header + ROONIUM_MEMORY_HEADER_SIZE;
+}
+
+void *roonium_memory__realloc(
+    void *_pointer,
+    const size_t _size)
+{
+  struct roonium_memory_header *header;
+  struct roonium_arena *arena = roonium_memory_scratch;
+  void *result;
+
+  if (!_pointer)
+    return roonium_memory__malloc(_size);
+
+  header = (struct roonium_memory_header *)(
+      (unsigned char *)_pointer - ROONIUM_MEMORY_HEADER_SIZE);
+
+  /* Last block of the scratch arena can grow in place. */
+  if (header->from_arena &&
+      arena &&
+      (unsigned char *)header == arena->data + arena->offset_last &&
+      arena->offset_last + ROONIUM_MEMORY_ALIGN(
+                               ROONIUM_MEMORY_HEADER_SIZE + _size) <=
+          arena->capacity)
+  {
+    arena->offset = arena->offset_last;
+    arena->stats.bytes_used -= ROONIUM_MEMORY_ALIGN(
+        ROONIUM_MEMORY_HEADER_SIZE + header->size);
+    roonium_arena__alloc(arena, ROONIUM_MEMORY_HEADER_SIZE + _size);
+    arena->stats.allocations_count--;
+    header->size = _size;
+    return _pointer;
+  }
+
+  result = roonium_memory__malloc(_size);
+  if (!result)
+    return NULL;
+
+  memcpy(result, _pointer, header->size < _size ? header->size : _size);
+  roonium_memory__free(_pointer);
+
+  return result;
+}
+
+void roonium_memory__free(
+    void *_pointer)
+{
+  struct roonium_memory_header *header;
+
+  if (!_pointer)
+    return;
+
+  header = (struct roonium_memory_header *)(
+      (unsigned char *)_pointer - ROONIUM_MEMORY_HEADER_SIZE);
+
+  /* Arena blocks die with the next reset. */
+  if (header->from_arena)
+    return;
+
+  roonium_memory_heap.bytes_used -= header->size;
+  free(header);
+}
+
+const struct roonium_memory_stats *roonium_memory__heap_stats(void)
+{
+  return &roonium_memory_heap;
+}
@@ -0,0 +1,86 @@
+#ifndef ROONIUM_MEMORY_H
+#define ROONIUM_MEMORY_H
+
+#include <stddef.h>
+
+#ifndef ROONIUM_MEMORY_ALIGNMENT
+#define ROONIUM_MEMORY_ALIGNMENT 16
+#endif
+
+/* Allocation counters. */
+typedef struct roonium_memory_stats
+{
+  size_t bytes_used;
+  size_t bytes_peak;
+  size_t allocations_count;
+} roonium_memory_stats;
+
+/* Linear arena. Allocations are released all at once by reset. */
+typedef struct roonium_arena
+{
+  unsigned char *data;
+  size_t capacity;
+  size_t offset;
+  size_t offset_last;
+  roonium_memory_stats stats;
+} roonium_arena;
+
+/* Pool of fixed-size elements. */
+typedef struct roonium_pool
+{
+  unsigned char *data;
+  size_t element_size;
+  size_t capacity;
+  void *free_list;
+  roonium_memory_stats stats;
+} roonium_pool;
+
+/* Arena. */
+int roonium_arena__init(
+    struct roonium_arena *_arena,
+    const size_t _capacity);
+
+void *roonium_arena__alloc(
+    struct roonium_arena *_arena,
+    const size_t _size);
+
+void roonium_arena__reset(
+    struct roonium_arena *_arena);
+
+void roonium_arena__free(
+    struct roonium_arena *_arena);
+
+/* Pool. */
+int roonium_pool__init(
+    struct roonium_pool *_pool,
+    const size_t _element_size,
+    const size_t _capacity);
+
+void *roonium_pool__alloc(
+    struct roonium_pool *_pool);
+
+void roonium_pool__release(
+    struct roonium_pool *_pool,
+    void *_element);
+
+void roonium_pool__free(
+    struct roonium_pool *_pool);
+
+/* Heap hook. Used by stb_image (STBI_MALLOC and friends).
+ * While a scratch arena is bound, allocations are taken from it and
+ * freeing them is a no-op. Otherwise they go to the heap and are counted. */
+void roonium_memory__bind_scratch(
+    struct roonium_arena *_arena);
+
+void *roonium_memory__malloc(
+    const size_t _size);
+
+void *roonium_memory__realloc(
+    void *_pointer,
+    const size_t _size);
+
+void roonium_memory__free(
+    void *_pointer);
+
+const struct roonium_memory_stats *roonium_memory__heap_stats(void);
+#endif
@@ -0,0 +1,815 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "roonium_mesh.h"
+
+/* Writes ROONIUM_PYRAMID_VERTICES_COUNT vertices. */
+void build_pyramid_vertices(
+    roonium_vertex *vertices,
+    const float _x,
+    const float _y,
+    const float _z)
+{
+  roonium_vector3 n, va, vb, vc;
+  roonium_vector2 ta, tb, tc;
+  int i = 0;
+
+  /* Toward. */
+  {
+    va.x = -_x / 2.0f;
+    va.y = -_y / 2.0;
+    va.z = _z / 2.0f;
+    ta.x = 0.0f;
+    ta.y = 0.0f;
+
+    vb.x = _x / 2.0f;
+    vb.y = -_y / 2.0;
+    vb.z = _z / 2.0f;
+    tb.x = 1.0f;
+    tb.y = 0.0f;
+
+    vc.x = 0.0f;
+    vc.y = _y / 2.0;
+    vc.z = 0.0f;
+    tc.x = 0.5f;
+    tc.y = 1.0f;
+
+    n = get_normal(va, vb, vc);
+
+    vertices[i + 0].position = va;
+    vertices[i + 1].position = vb;
+    vertices[i + 2].position = vc;
+    vertices[i + 0].normals = n;
+    vertices[i + 1].normals = n;
+    vertices[i + 2].normals = n;
+    vertices[i + 0].texture_coordinates = ta;
+    vertices[i + 1].texture_coordinates = tb;
+    vertices[i + 2].texture_coordinates = tc;
+
+    i += 3;
+  }
+
+  /* Backward. */
+  {
+    va.x = _x / 2.0f;
+    va.y = -_y / 2.0;
+    va.z = -_z / 2.0f;
+    ta.x = 0.0f;
+    ta.y = 0.0f;
+    vb.x = -_x / 2.0f;
+    vb.y = -_y / 2.0;
+    vb.z = -_z / 2.0f;
+    tb.x = 1.0f;
+    tb.y = 0.0f;
+    vc.x = 0.0f;
+    vc.y = _y / 2.0;
+    vc.z = 0.0f;
+    tc.x = 0.5f;
+    tc.y = 1.0f;
+
+    n = get_normal(va, vb, vc);
+
+    vertices[i + 0].position = va;
+    vertices[i + 1].position = vb;
+    vertices[i + 2].position = vc;
+    vertices[i + 0].normals = n;
+    vertices[i + 1].normals = n;
+    vertices[i + 2].normals = n;
+    vertices[i + 0].texture_coordinates = ta;
+    vertices[i + 1].texture_coordinates = tb;
+    vertices[i + 2].texture_coordinates = tc;
+
+    i += 3;
+  }
+
+  /* left. */
+  {
+    va.x = -_x / 2.0f;
+    va.y = -_y / 2.0;
+    va.z = -_z / 2.0f;
+    ta.x = 0.0f;
+    ta.y = 0.0f;
+    vb.x = -_x / 2.0f;
+    vb.y = -_y / 2.0;
+    vb.z = _z / 2.0f;
+    tb.x = 1.0f;
+    tb.y = 0.0f;
+    vc.x = 0.0f;
+    vc.y = _y / 2.0;
+    vc.z = 0.0f;
+    tc.x = 0.5f;
+    tc.y = 1.0f;
+
+    n = get_normal(va, vb, vc);
+
+    vertices[i + 0].position = va;
+    vertices[i + 1].position = vb;
+    vertices[i + 2].position = vc;
+    vertices[i + 0].normals = n;
+    vertices[i + 1].normals = n;
+    vertices[i + 2].normals = n;
+    vertices[i + 0].texture_coordinates = ta;
+    vertices[i + 1].texture_coordinates = tb;
+    vertices[i + 2].texture_coordinates = tc;
+
+    i += 3;
+  }
+
+  /* Right. */
+  {
+    va.x = _x / 2.0f;
+    va.y = -_y / 2.0;
+    va.z = _z / 2.0f;
+    ta.x = 0.0f;
+    ta.y = 0.0f;
+    vb.x = _x / 2.0f;
+    vb.y = -_y / 2.0;
+    vb.z = -_z / 2.0f;
+    tb.x = 1.0f;
+    tb.y = 0.0f;
+    vc.x = 0.0f;
+    vc.y = _y / 2.0;
+    vc.z = 0.0f;
+    tc.x = 0.5f;
+    tc.y = 1.0f;
+
+    n = get_normal(va, vb, vc);
+
+    vertices[i + 0].position = va;
+    vertices[i + 1].position = vb;
+    vertices[i + 2].position = vc;
+    vertices[i + 0].normals = n;
+    vertices[i + 1].normals = n;
+    vertices[i + 2].normals = n;
+    vertices[i + 0].texture_coordinates = ta;
+    vertices[i + 1].texture_coordinates = tb;
+    vertices[i + 2].texture_coordinates = tc;
+
+    i += 3;
+  }
+
+  /* Bottom square. */
+  {
+    va.x = -_x / 2.0f;
+    va.y = -_y / 2.0;
+    va.z = -_z / 2.0f;
+    ta.x = 0.0f;
+    ta.y = 1.0f;
+    vb.x = _x / 2.0f;
+    vb.y = -_y / 2.0;
+    vb.z = -_z / 2.0f;
+    tb.x = 1.0f;
+    tb.y = 1.0f;
+    vc.x = -_x / 2.0f;
+    vc.y = -_y / 2.0;
+    vc.z = _z / 2.0f;
+    tc.x = 0.0f;
+    tc.y = 0.0f;
+
+    n = get_normal(va, vb, vc);
+
+    vertices[i + 0].position = va;
+    vertices[i + 1].position = vb;
+    vertices[i + 2].position = vc;
+    vertices[i + 0].normals = n;
+    vertices[i + 1].normals = n;
+    vertices[i + 2].normals = n;
+    vertices[i + 0].texture_coordinates = ta;
+    vertices[i + 1].texture_coordinates = tb;
+    vertices[i + 2].texture_coordinates = tc;
+    i += 3;
+
+    va.x = -_x / 2.0f;
+    va.y = -_y / 2.0;
+    va.z = _z / 2.0f;
+    ta.x = 1.0f;
+    ta.y = 0.0f;
+    vb.x = _x / 2.0f;
+    vb.y = -_y / 2.0;
+    vb.z = -_z / 2.0f;
+    tb.x = 0.0f;
+    tb.y = 1.0f;
+    vc.x = _x / 2.0f;
+    vc.y = -_y / 2.0;
+    vc.z = _z / 2.0f;
+    tc.x = 0.0f;
+    tc.y = 0.0f;
+
+    vertices[i + 0].position = va;
+    vertices[i + 1].position = vb;
+    vertices[i + 2].position = vc;
+    vertices[i + 0].normals = n;
+    vertices[i + 1].normals = n;
+    vertices[i + 2].normals = n;
+    vertices[i + 0].texture_coordinates = ta;
+    vertices[i + 1].texture_coordinates = tb;
+    vertices[i + 2].texture_coordinates = tc;
+  }
+}
+
+int build_mesh_data_sphere(
+    struct roonium_mesh_data *_data,
+    struct roonium_arena *_arena,
+    const float _radius,
+    const float _bumpiness,
+    const size_t _rings,
+    const size_t _segments)
+{
+  const size_t row = _segments + 1;
+  roonium_vertex *vertex;
+  roonium_vector3 direction;
+  unsigned int a, b, c, d, *index;
+  double theta, phi, scale;
+  size_t r, s;
+
+  memset(_data, 0, sizeof(*_data));
+  _data->vertices_count = (_rings + 1) * row;
+  _data->vertices = roonium_arena__alloc(
+      _arena,
+      _data->vertices_count * sizeof(roonium_vertex));
+  _data->indices = roonium_arena__alloc(
+      _arena,
+      _rings * _segments * 6 * sizeof(unsigned int));
+
+  if (!_data->vertices || !_data->indices)
+    return 1;
+
+  r = 0;
+  while (r <= _rings)
+  {
+    theta = M_PI * (double)r / (double)_rings;
+    s = 0;
+    while (s <= _segments)
+    {
+      phi = 2.0 * M_PI * (double)s / (double)_segments;
+      direction.x = (float)(sin(theta) * cos(phi));
+      direction.y = (float)cos(theta);
+      direction.z = (float)(sin(theta) * sin(phi));
+      scale = _radius * (1.0 + _bumpiness * sin(6.0 * theta) * sin(6.0 * phi));
+
+      vertex = &_data->vertices[r * row + s];
+      vertex->position.x = (float)(direction.x * scale);
+      vertex->position.y = (float)(direction.y * scale);
+      vertex->position.z = (float)(direction.z * scale);
+      vertex->normals = direction;
+      vertex->texture_coordinates.x = (float)s / (float)_segments;
+      vertex->texture_coordinates.y = 1.0f - (float)r / (float)_rings;
+      s++;
+    }
+    r++;
+  }
+
+  /* Counter-clockwise from outside; the pole triangles of each quad are
+   * degenerate and skipped. */
+  index = _data->indices;
+  r = 0;
+  while (r < _rings)
+  {
+    s = 0;
+    while (s < _segments)
+    {
+      a = (unsigned int)(r * row + s);
+      b = a + (unsigned int)row;
+      c = b + 1;
+      d = a + 1;
+      if (r != 0)
+      {
+        *index++ = a;
+        *index++ = d;
+        *index++ = b;
+      }
+      if (r != _rings - 1)
+      {
+        *index++ = d;
+        *index++ = c;
+        *index++ = b;
+      }
+      s++;
+    }
+    r++;
+  }
+
+  _data->indices_count = (size_t)(index - _data->indices);
+  _data->lods[0].indices_first = 0;
+  _data->lods[0].indices_count = _data->indices_count;
+  _data->lods_count = 1;
+  _data->radius = _radius * (1.0f + (_bumpiness > 0.0f ? _bumpiness : -_bumpiness));
+
+  return 0;
+}
+
+/* Symmetric 4x4 error quadric: a2 ab ac ad b2 bc bd c2 cd d2. */
+typedef struct roonium_quadric
+{
+  double q[10];
+} roonium_quadric;
+
+typedef struct roonium_lod_edge
+{
+  unsigned int a, b;
+  unsigned int from, to;
+  double cost;
+} roonium_lod_edge;
+
+typedef struct roonium_lod_point
+{
+  float x, y, z;
+  unsigned int index;
+} roonium_lod_point;
+
+static void quadric_add_plane(
+    struct roonium_quadric *_quadric,
+    const double _a,
+    const double _b,
+    const double _c,
+    const double _d,
+    const double _weight)
+{
+  double *q = _quadric->q;
+
+  q[0] += _weight * _a * _a;
+  q[1] += _weight * _a * _b;
+  q[2] += _weight * _a * _c;
+  q[3] += _weight * _a * _d;
+  q[4] += _weight * _b * _b;
+  q[5] += _weight * _b * _c;
+  q[6] += _weight * _b * _d;
+  q[7] += _weight * _c * _c;
+  q[8] += _weight * _c * _d;
+  q[9] += _weight * _d * _d;
+}
+
+static double quadric_error(
+    const struct roonium_quadric *_a,
+    const struct roonium_quadric *_b,
+    const roonium_vector3 _p)
+{
+  double q[10];
+  const double x = _p.x, y = _p.y, z = _p.z;
+  int i = 0;
+
+  while (i < 10)
+  {
+    q[i] = _a->q[i] + _b->q[i];
+    i++;
+  }
+
+  return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z +
+         2.0 * q[3] * x + q[4] * y * y + 2.0 * q[5] * y * z +
+         2.0 * q[6] * y + q[7] * z * z + 2.0 * q[8] * z + q[9];
+}
+
+static roonium_vector3 triangle_normal(
+    const roonium_vector3 _a,
+    const roonium_vector3 _b,
+    const roonium_vector3 _c)
+{
+  return vector3_cross(
+      vector3_subtract(_b, _a),
+      vector3_subtract(_c, _a));
+}
+
+static int lod_point_compare(
+    const void *_a,
+    const void *_b)
+{
+  const struct roonium_lod_point *a = _a;
+  const struct roonium_lod_point *b = _b;
+
+  if (a->x != b->x)
+    return a->x < b->x ? -1 : 1;
+  if (a->y != b->y)
+    return a->y < b->y ? -1 : 1;
+  if (a->z != b->z)
+    return a->z < b->z ? -1 : 1;
+  return 0;
+}
+
+static int lod_edge_compare_vertices(
+    const void *_a,
+    const void *_b)
+{
+  const struct roonium_lod_edge *a = _a;
+  const struct roonium_lod_edge *b = _b;
+
+  if (a->a != b->a)
+    return a->a < b->a ? -1 : 1;
+  if (a->b != b->b)
+    return a->b < b->b ? -1 : 1;
+  return 0;
+}
+
+static int lod_edge_compare_cost(
+    const void *_a,
+    const void *_b)
+{
+  const double a = ((const struct roonium_lod_edge *)_a)->cost;
+  const double b = ((const struct roonium_lod_edge *)_b)->cost;
+
+  return (a > b) - (a < b);
+}
+
+/* Rejects collapses that flip a triangle or pinch the surface. */
+static int lod_collapse_is_valid(
+    const struct roonium_mesh_data *_data,
+    const unsigned int *_triangles,
+    const size_t *_adjacency_offsets,
+    const unsigned int *_adjacency,
+    const unsigned int _from,
+    const unsigned int _to)
+{
+  const unsigned int *t, *u;
+  roonium_vector3 p[3], before, after;
+  size_t i, j, k, shared = 0, common = 0;
+  unsigned int n;
+
+  i = _adjacency_offsets[_from];
+  while (i < _adjacency_offsets[_from + 1])
+  {
+    t = &_triangles[_adjacency[i] * 3];
+    i++;
+
+    if (t[0] == _to || t[1] == _to || t[2] == _to)
+    {
+      shared++;
+      continue;
+    }
+
+    k = 0;
+    while (k < 3)
+    {
+      p[k] = _data->vertices[t[k]].position;
+      k++;
+    }
+    before = triangle_normal(p[0], p[1], p[2]);
+    k = 0;
+    while (k < 3)
+    {
+      if (t[k] == _from)
+        p[k] = _data->vertices[_to].position;
+      k++;
+    }
+    after = triangle_normal(p[0], p[1], p[2]);
+
+    if (before.x * after.x + before.y * after.y + before.z * after.z <= 0.0f)
+      return 0;
+  }
+
+  /* Link condition: only the opposite vertices of the shared triangles
+   * may be neighbours of both ends. */
+  i = _adjacency_offsets[_from];
+  while (i < _adjacency_offsets[_from + 1])
+  {
+    t = &_triangles[_adjacency[i] * 3];
+    k = 0;
+    while (k < 3)
+    {
+      n = t[k];
+      k++;
+      if (n == _from || n == _to)
+        continue;
+
+      j = _adjacency_offsets[_to];
+      while (j < _adjacency_offsets[_to + 1])
+      {
+        u = &_triangles[_adjacency[j] * 3];
+        if (u[0] == n || u[1] == n || u[2] == n)
+        {
+          common++;
+          break;
+        }
+        j++;
+      }
+    }
+    i++;
+  }
+
+  /* Every common neighbour is counted once per triangle of _from. */
+  return common <= shared * 2;
+}
+
+int build_mesh_data_lods(
+    struct roonium_mesh_data *_data,
+    struct roonium_arena *_arena,
+    const size_t _levels_count)
+{
+  const size_t vertices_count = _data->vertices_count;
+  const size_t base_count = _data->lods[0].indices_count;
+  struct roonium_quadric *quadrics;
+  struct roonium_lod_point *points;
+  struct roonium_lod_edge *edges, *edge;
+  unsigned char *locked, *touched;
+  unsigned int *triangles, *indices, *remap, *adjacency, *t;
+  size_t *adjacency_offsets;
+  size_t triangles_count, target, edges_count, unique_count;
+  size_t collapses, removed, level, i, j, k, run;
+  roonium_vector3 n;
+  double length;
+
+  if (_data->lods_count != 1 || _levels_count <= 1)
+    return 0;
+
+  quadrics = roonium_arena__alloc(
+      _arena,
+      vertices_count * sizeof(struct roonium_quadric));
+  points = roonium_arena__alloc(
+      _arena,
+      vertices_count * sizeof(struct roonium_lod_point));
+  locked = roonium_arena__alloc(_arena, vertices_count);
+  touched = roonium_arena__alloc(_arena, vertices_count);
+  remap = roonium_arena__alloc(_arena, vertices_count * sizeof(unsigned int));
+  adjacency_offsets = roonium_arena__alloc(
+      _arena,
+      (vertices_count + 1) * sizeof(size_t));
+  adjacency = roonium_arena__alloc(_arena, base_count * sizeof(unsigned int));
+  triangles = roonium_arena__alloc(_arena, base_count * sizeof(unsigned int));
+  edges = roonium_arena__alloc(
+      _arena,
+      base_count * sizeof(struct roonium_lod_edge));
+  /* Levels halve, so all of them fit in twice the base. */
+  indices = roonium_arena__alloc(
+      _arena,
+      base_count * 2 * sizeof(unsigned int));
+
+  if (!quadrics || !points || !locked || !touched || !remap ||
+      !adjacency_offsets || !adjacency || !triangles || !edges || !indices)
+    return 1;
+
+  memcpy(triangles, _data->indices, base_count * sizeof(unsigned int));
+  memcpy(indices, _data->indices, base_count * sizeof(unsigned int));
+  _data->indices = indices;
+  _data->indices_count = base_count;
+  triangles_count = base_count / 3;
+
+  /* Lock seams: vertices sharing a position with another vertex. */
+  memset(locked, 0, vertices_count);
+  i = 0;
+  while (i < vertices_count)
+  {
+    points[i].x = _data->vertices[i].position.x;
+    points[i].y = _data->vertices[i].position.y;
+    points[i].z = _data->vertices[i].position.z;
+    points[i].index = (unsigned int)i;
+    remap[i] = (unsigned int)i;
+    i++;
+  }
+  qsort(points, vertices_count, sizeof(*points), lod_point_compare);
+  i = 0;
+  while (i < vertices_count)
+  {
+    run = i + 1;
+    while (run < vertices_count &&
+           !lod_point_compare(&points[i], &points[run]))
+      run++;
+    if (run - i > 1)
+    {
+      while (i < run)
+        locked[points[i++].index] = 1;
+    }
+    i = run;
+  }
+
+  /* Area weighted plane quadrics. */
+  memset(quadrics, 0, vertices_count * sizeof(struct roonium_quadric));
+  i = 0;
+  while (i < triangles_count)
+  {
+    t = &triangles[i * 3];
+    n = triangle_normal(
+        _data->vertices[t[0]].position,
+        _data->vertices[t[1]].position,
+        _data->vertices[t[2]].position);
+    length = sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+    i++;
+    if (length <= 0.0)
+      continue;
+
+    k = 0;
+    while (k < 3)
+    {
+      quadric_add_plane(
+          &quadrics[t[k]],
+          n.x / length,
+          n.y / length,
+          n.z / length,
+          -(n.x * _data->vertices[t[0]].position.x +
+            n.y * _data->vertices[t[0]].position.y +
+            n.z * _data->vertices[t[0]].position.z) /
+              length,
+          length * 0.5);
+      k++;
+    }
+  }
+
+  level = 1;
+  while (level < _levels_count && level < ROONIUM_LOD_LEVELS_MAX)
+  {
+    target = triangles_count / 2;
+    collapses = 1;
+
+    while (triangles_count > target && collapses)
+    {
+      /* Unique edges; edges with one triangle are boundaries. */
+      edges_count = 0;
+      i = 0;
+      while (i < triangles_count * 3)
+      {
+        edge = &edges[edges_count++];
+        edge->a = triangles[i];
+        edge->b = triangles[i % 3 == 2 ? i - 2 : i + 1];
+        if (edge->a > edge->b)
+        {
+          edge->from = edge->a;
+          edge->a = edge->b;
+          edge->b = edge->from;
+        }
+        i++;
+      }
+      qsort(edges, edges_count, sizeof(*edges), lod_edge_compare_vertices);
+
+      unique_count = 0;
+      i = 0;
+      while (i < edges_count)
+      {
+        run = i + 1;
+        while (run < edges_count &&
+               !lod_edge_compare_vertices(&edges[i], &edges[run]))
+          run++;
+        if (run - i == 1)
+        {
+          locked[edges[i].a] = 1;
+          locked[edges[i].b] = 1;
+        }
+        edges[unique_count++] = edges[i];
+        i = run;
+      }
+
+      /* Cheapest direction of every edge. */
+      edges_count = 0;
+      i = 0;
+      while (i < unique_count)
+      {
+        edge = &edges[i++];
+        if (locked[edge->a] && locked[edge->b])
+          continue;
+
+        if (locked[edge->a])
+        {
+          edge->from = edge->b;
+          edge->to = edge->a;
+        }
+        else if (locked[edge->b])
+        {
+          edge->from = edge->a;
+          edge->to = edge->b;
+        }
+        else if (quadric_error(
+                     &quadrics[edge->a],
+                     &quadrics[edge->b],
+                     _data->vertices[edge->b].position) <
+                 quadric_error(
+                     &quadrics[edge->a],
+                     &quadrics[edge->b],
+                     _data->vertices[edge->a].position))
+        {
+          edge->from = edge->a;
+          edge->to = edge->b;
+        }
+        else
+        {
+          edge->from = edge->b;
+          edge->to = edge->a;
+        }
+        edge->cost = quadric_error(
+            &quadrics[edge->from],
+            &quadrics[edge->to],
+            _data->vertices[edge->to].position);
+        edges[edges_count++] = *edge;
+      }
+      qsort(edges, edges_count, sizeof(*edges), lod_edge_compare_cost);
+
+      /* Vertex to triangles. */
+      memset(adjacency_offsets, 0, (vertices_count + 1) * sizeof(size_t));
+      i = 0;
+      while (i < triangles_count * 3)
+        adjacency_offsets[triangles[i++] + 1]++;
+      i = 0;
+      while (i < vertices_count)
+      {
+        adjacency_offsets[i + 1] += adjacency_offsets[i];
+        i++;
+      }
+      i = 0;
+      while (i < triangles_count * 3)
+      {
+        adjacency[adjacency_offsets[triangles[i]]++] = (unsigned int)(i / 3);
+        i++;
+      }
+      i = vertices_count;
+      while (i > 0)
+      {
+        adjacency_offsets[i] = adjacency_offsets[i - 1];
+        i--;
+      }
+      adjacency_offsets[0] = 0;
+
+      /* Independent collapses, cheapest first. */
+      memset(touched, 0, vertices_count);
+      collapses = 0;
+      removed = 0;
+      i = 0;
+      while (i < edges_count && triangles_count - removed > target)
+      {
+        edge = &edges[i++];
+        if (touched[edge->from] || touched[edge->to] ||
+            !lod_collapse_is_valid(
+                _data,
+                triangles,
+                adjacency_offsets,
+                adjacency,
+                edge->from,
+                edge->to))
+          continue;
+
+        j = adjacency_offsets[edge->from];
+        while (j < adjacency_offsets[edge->from + 1])
+        {
+          t = &triangles[adjacency[j++] * 3];
+          touched[t[0]] = 1;
+          touched[t[1]] = 1;
+          touched[t[2]] = 1;
+          if (t[0] == edge->to || t[1] == edge->to || t[2] == edge->to)
+            removed++;
+        }
+
+        remap[edge->from] = edge->to;
+        k = 0;
+        while (k < 10)
+        {
+          quadrics[edge->to].q[k] += quadrics[edge->from].q[k];
+          k++;
+        }
+        collapses++;
+      }
+
+      /* Apply and drop degenerate triangles. */
+      j = 0;
+      i = 0;
+      while (i < triangles_count)
+      {
+        t = &triangles[i * 3];
+        t[0] = remap[t[0]];
+        t[1] = remap[t[1]];
+        t[2] = remap[t[2]];
+        i++;
+        if (t[0] == t[1] || t[1] == t[2] || t[2] == t[0])
+          continue;
+        memmove(&triangles[j * 3], t, 3 * sizeof(unsigned int));
+        j++;
+      }
+      triangles_count = j;
+    }
+
+    /* Nothing left to collapse. */
+    if (triangles_count * 3 >= _data->lods[level - 1].indices_count)
+      break;
+
+    _data->lods[level].indices_first = _data->indices_count;
+    _data->lods[level].indices_count = triangles_count * 3;
+    memcpy(
+        _data->indices + _data->indices_count,
+        triangles,
+        triangles_count * 3 * sizeof(unsigned int));
+    _data->indices_count += triangles_count * 3;
+    _data->lods_count++;
+    level++;
+  }
+
+  return 0;
+}
+
+size_t select_lod_level(
+    const size_t _current,
+    const size_t _levels_count,
+    const float _screen_size)
+{
+  size_t level;
+
+  if (!_levels_count)
+    return 0;
+
+  level = _current < _levels_count ? _current : _levels_count - 1;
+
+  while (level + 1 < _levels_count &&
+         _screen_size < ROONIUM_LOD_SCREEN_SIZE / (float)(1 << level) *
+                            (1.0f - ROONIUM_LOD_HYSTERESIS))
+    level++;
+
+  while (level > 0 &&
+         _screen_size > ROONIUM_LOD_SCREEN_SIZE / (float)(1 << (level - 1)) *
+                            (1.0f + ROONIUM_LOD_HYSTERESIS))
+    level--;
+
+  return level;
+}
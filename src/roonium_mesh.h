@@ -0,0 +1,85 @@
+#ifndef ROONIUM_MESH_H
+#define ROONIUM_MESH_H
+
+#include <stddef.h>
+#include <roonmath.h>
+
+#include "roonium_memory.h"
+
+#define ROONIUM_PYRAMID_VERTICES_COUNT 18
+
+#ifndef ROONIUM_LOD_LEVELS_MAX
+#define ROONIUM_LOD_LEVELS_MAX 4
+#endif
+
+/* Projected diameter, as a fraction of the screen height, below which
+ * level 0 is replaced by level 1. Every next level halves it. */
+#ifndef ROONIUM_LOD_SCREEN_SIZE
+#define ROONIUM_LOD_SCREEN_SIZE 0.4f
+#endif
+
+/* Relative band around each threshold where the level is kept. */
+#ifndef ROONIUM_LOD_HYSTERESIS
+#define ROONIUM_LOD_HYSTERESIS 0.15f
+#endif
+
+/* Vertex. */
+typedef struct roonium_vertex
+{
+  roonium_vector3 position;
+  roonium_vector3 normals;
+  roonium_vector2 texture_coordinates;
+} roonium_vertex;
+
+/* Range of one level of detail in a shared index buffer. */
+typedef struct roonium_lod_level
+{
+  size_t indices_first;
+  size_t indices_count;
+} roonium_lod_level;
+
+/* Indexed geometry on the CPU side. */
+typedef struct roonium_mesh_data
+{
+  roonium_vertex *vertices;
+  size_t vertices_count;
+  unsigned int *indices;
+  size_t indices_count;
+  struct roonium_lod_level lods[ROONIUM_LOD_LEVELS_MAX];
+  size_t lods_count;
+  float radius;
+} roonium_mesh_data;
+
+/* Writes ROONIUM_PYRAMID_VERTICES_COUNT vertices. */
+void build_pyramid_vertices(
+    roonium_vertex *vertices,
+    const float _x,
+    const float _y,
+    const float _z);
+
+/* UV sphere with _rings x _segments quads. _bumpiness displaces the
+ * surface so simplification has something to lose. Returns 0 on success. */
+int build_mesh_data_sphere(
+    struct roonium_mesh_data *_data,
+    struct roonium_arena *_arena,
+    const float _radius,
+    const float _bumpiness,
+    const size_t _rings,
+    const size_t _segments);
+
+/* Appends up to _levels_count - 1 simplified levels after level 0, each
+ * with about half the triangles of the previous one. Uses quadric error
+ * half-edge collapses, so every level indexes the same vertices.
+ * Seams and boundaries are kept. Returns 0 on success. */
+int build_mesh_data_lods(
+    struct roonium_mesh_data *_data,
+    struct roonium_arena *_arena,
+    const size_t _levels_count);
+
+/* Picks a level from the projected size, keeping _current inside the
+ * hysteresis band. */
+size_t select_lod_level(
+    const size_t _current,
+    const size_t _levels_count,
+    const float _screen_size);
+#endif
@@ -0,0 +1,199 @@
+#include <string.h>
+#include <math.h>
+#include <glad/glad.h>
+
+#include "roonium_resolution.h"
+
+int roonium_resolution__init(
+    struct roonium_resolution *_resolution)
+{
+  memset(_resolution, 0, sizeof(*_resolution));
+  _resolution->scale = ROONIUM_RESOLUTION_SCALE_MAX;
+  _resolution->enabled = true;
+
+  glGenFramebuffers(1, &_resolution->framebuffer);
+  glGenRenderbuffers(1, &_resolution->color);
+  glGenRenderbuffers(1, &_resolution->depth);
+  glGenQueries(ROONIUM_RESOLUTION_QUERIES, _resolution->queries);
+
+  return glGetError() != GL_NO_ERROR;
+}
+
+/* Targets are as big as the window, a frame only uses its lower left
+ * corner, so changing the scale never reallocates. */
+static int roonium_resolution__resize(
+    struct roonium_resolution *_resolution,
+    const int _width,
+    const int _height)
+{
+  GLenum status;
+
+  glBindRenderbuffer(GL_RENDERBUFFER, _resolution->color);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, _width, _height);
+  glBindRenderbuffer(GL_RENDERBUFFER, _resolution->depth);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, _width, _height);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, _resolution->framebuffer);
+  glFramebufferRenderbuffer(
+      GL_FRAMEBUFFER,
+      GL_COLOR_ATTACHMENT0,
+      GL_RENDERBUFFER,
+      _resolution->color);
+  glFramebufferRenderbuffer(
+      GL_FRAMEBUFFER,
+      GL_DEPTH_ATTACHMENT,
+      GL_RENDERBUFFER,
+      _resolution->depth);
+  status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    _resolution->width = 0;
+    _resolution->height = 0;
+    return 1;
+  }
+
+  _resolution->width = _width;
+  _resolution->height = _height;
+
+  return 0;
+}
+
+void roonium_resolution__update(
+    struct roonium_resolution *_resolution,
+    const double _frame_time)
+{
+  const double budget = _frame_time * ROONIUM_RESOLUTION_BUDGET;
+  GLint available;
+  GLuint64 elapsed;
+  float target;
+  size_t index;
+
+  while (_resolution->queries_pending)
+  {
+    index = (_resolution->query_next + ROONIUM_RESOLUTION_QUERIES -
+             _resolution->queries_pending) %
+            ROONIUM_RESOLUTION_QUERIES;
+    glGetQueryObjectiv(
+        _resolution->queries[index],
+        GL_QUERY_RESULT_AVAILABLE,
+        &available);
+    if (!available)
+      break;
+
+    glGetQueryObjectui64v(
+        _resolution->queries[index],
+        GL_QUERY_RESULT,
+        &elapsed);
+    _resolution->queries_pending--;
+    _resolution->gpu_time = (double)elapsed * 1e-9;
+
+    if (!_resolution->enabled ||
+        _resolution->gpu_time <= 0.0 ||
+        fabs(_resolution->gpu_time - budget) <=
+            budget * ROONIUM_RESOLUTION_DEADBAND)
+      continue;
+
+    /* Cost follows the pixel count, the square of the scale. The
+     * result is relative to the scale the measured frame had. */
+    target = _resolution->queries_scale[index] *
+             (float)sqrt(budget / _resolution->gpu_time);
+    _resolution->scale += (target - _resolution->scale) * ROONIUM_RESOLUTION_GAIN;
+    if (_resolution->scale < ROONIUM_RESOLUTION_SCALE_MIN)
+      _resolution->scale = ROONIUM_RESOLUTION_SCALE_MIN;
+    if (_resolution->scale > ROONIUM_RESOLUTION_SCALE_MAX)
+      _resolution->scale = ROONIUM_RESOLUTION_SCALE_MAX;
+  }
+}
+
+int roonium_resolution__begin(
+    struct roonium_resolution *_resolution,
+    const int _width,
+    const int _height)
+{
+  int result = 0;
+
+  /* A minimized window has no size. */
+  _resolution->offscreen = _resolution->enabled && _width > 0 && _height > 0;
+  if (_resolution->offscreen &&
+      (_resolution->width != _width || _resolution->height != _height))
+  {
+    result = roonium_resolution__resize(_resolution, _width, _height);
+    _resolution->enabled = !result;
+    _resolution->offscreen = !result;
+  }
+
+  if (_resolution->offscreen)
+  {
+    _resolution->render_width = (int)(_width * _resolution->scale + 0.5f);
+    _resolution->render_height = (int)(_height * _resolution->scale + 0.5f);
+    if (_resolution->render_width < 1)
+      _resolution->render_width = 1;
+    if (_resolution->render_height < 1)
+      _resolution->render_height = 1;
+    glBindFramebuffer(GL_FRAMEBUFFER, _resolution->framebuffer);
+  }
+  else
+  {
+    if (!_resolution->enabled)
+      _resolution->scale = ROONIUM_RESOLUTION_SCALE_MAX;
+    _resolution->render_width = _width;
+    _resolution->render_height = _height;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+  glViewport(0, 0, _resolution->render_width, _resolution->render_height);
+
+  /* With every query in flight this frame goes untimed. */
+  _resolution->query_active =
+      _resolution->queries_pending < ROONIUM_RESOLUTION_QUERIES;
+  if (_resolution->query_active)
+  {
+    _resolution->queries_scale[_resolution->query_next] = _resolution->scale;
+    glBeginQuery(GL_TIME_ELAPSED, _resolution->queries[_resolution->query_next]);
+  }
+
+  return result;
+}
+
+void roonium_resolution__end(
+    struct roonium_resolution *_resolution)
+{
+  if (_resolution->offscreen)
+  {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _resolution->framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(
+        0,
+        0,
+        _resolution->render_width,
+        _resolution->render_height,
+        0,
+        0,
+        _resolution->width,
+        _resolution->height,
+        GL_COLOR_BUFFER_BIT,
+        GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+  if (_resolution->query_active)
+  {
+    glEndQuery(GL_TIME_ELAPSED);
+    _resolution->query_next =
+        (_resolution->query_next + 1) % ROONIUM_RESOLUTION_QUERIES;
+    _resolution->queries_pending++;
+    _resolution->query_active = false;
+  }
+}
+
+void roonium_resolution__free(
+    struct roonium_resolution *_resolution)
+{
+  glDeleteQueries(ROONIUM_RESOLUTION_QUERIES, _resolution->queries);
+  glDeleteRenderbuffers(1, &_resolution->color);
+  glDeleteRenderbuffers(1, &_resolution->depth);
+  glDeleteFramebuffers(1, &_resolution->framebuffer);
+  memset(_resolution, 0, sizeof(*_resolution));
+}
@@ -0,0 +1,81 @@
+#ifndef ROONIUM_RESOLUTION_H
+#define ROONIUM_RESOLUTION_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <glad/glad.h>
+
+#ifndef ROONIUM_RESOLUTION_SCALE_MIN
+#define ROONIUM_RESOLUTION_SCALE_MIN 0.5f
+#endif
+#define ROONIUM_RESOLUTION_SCALE_MAX 1.0f
+
+/* Share of the frame budget the GPU may use. */
+#ifndef ROONIUM_RESOLUTION_BUDGET
+#define ROONIUM_RESOLUTION_BUDGET 0.9
+#endif
+
+/* GPU times within this fraction of the budget leave the scale alone. */
+#ifndef ROONIUM_RESOLUTION_DEADBAND
+#define ROONIUM_RESOLUTION_DEADBAND 0.1
+#endif
+
+/* Fraction of the correction applied per measurement. */
+#ifndef ROONIUM_RESOLUTION_GAIN
+#define ROONIUM_RESOLUTION_GAIN 0.25f
+#endif
+
+/* Timer queries in flight. Results are read when ready, a few frames
+ * late, so the CPU never waits for the GPU. */
+#ifndef ROONIUM_RESOLUTION_QUERIES
+#define ROONIUM_RESOLUTION_QUERIES 4
+#endif
+
+/* Offscreen target drawn at a fraction of the window size and blitted
+ * up to it. The scale follows the GPU time of the frames. */
+typedef struct roonium_resolution
+{
+  GLuint framebuffer;
+  GLuint color;
+  GLuint depth;
+  int width, height;
+  int render_width, render_height;
+  float scale;
+  bool enabled;
+  bool offscreen;
+
+  /* Ring of GL_TIME_ELAPSED queries, with the scale each one saw. */
+  GLuint queries[ROONIUM_RESOLUTION_QUERIES];
+  float queries_scale[ROONIUM_RESOLUTION_QUERIES];
+  size_t query_next;
+  size_t queries_pending;
+  bool query_active;
+  double gpu_time;
+} roonium_resolution;
+
+/* Returns 0 on success. */
+int roonium_resolution__init(
+    struct roonium_resolution *_resolution);
+
+/* Reads finished queries and moves the scale towards the GPU time that
+ * fits _frame_time. */
+void roonium_resolution__update(
+    struct roonium_resolution *_resolution,
+    const double _frame_time);
+
+/* Binds the target to draw a frame for a _width x _height window, sets
+ * the viewport and starts timing. Draws straight to the window when
+ * disabled. Returns 1 and disables itself if the target cannot be
+ * created. */
+int roonium_resolution__begin(
+    struct roonium_resolution *_resolution,
+    const int _width,
+    const int _height);
+
+/* Stops timing and scales the frame up to the window. */
+void roonium_resolution__end(
+    struct roonium_resolution *_resolution);
+
+void roonium_resolution__free(
+    struct roonium_resolution *_resolution);
+#endif
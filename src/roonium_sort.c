@@ -0,0 +1,111 @@
+#include <string.h>
+
+#include "roonium_sort.h"
+
+#define ROONIUM_SORT_PASSES 4
+#define ROONIUM_SORT_BUCKETS 256
+
+unsigned int roonium_sort__float_key(
+    const float _value)
+{
+  unsigned int bits;
+
+  /* -0 equals 0. */
+  if (_value == 0.0f)
+    return 0x80000000u;
+  memcpy(&bits, &_value, sizeof(bits));
+
+  /* Negatives reversed below the positives. */
+  return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+}
+
+struct roonium_sort_key *roonium_sort__radix(
+    struct roonium_sort_key *_keys,
+    struct roonium_sort_key *_scratch,
+    const size_t _count)
+{
+  size_t counts[ROONIUM_SORT_PASSES][ROONIUM_SORT_BUCKETS];
+  struct roonium_sort_key *source = _keys, *destination = _scratch, *swap;
+  size_t i, pass, offset, count;
+  unsigned int shift;
+
+  if (_count < 2)
+    return _keys;
+
+  memset(counts, 0, sizeof(counts));
+
+  /* Every histogram in one read. */
+  i = 0;
+  while (i < _count)
+  {
+    pass = 0;
+    while (pass < ROONIUM_SORT_PASSES)
+    {
+      counts[pass][(_keys[i].key >> (pass * 8)) & 0xff]++;
+      pass++;
+    }
+    i++;
+  }
+
+  pass = 0;
+  while (pass < ROONIUM_SORT_PASSES)
+  {
+    shift = (unsigned int)pass * 8;
+    /* _keys[0] is still one of the keys, whatever order it is in. */
+    if (counts[pass][(_keys[0].key >> shift) & 0xff] == _count)
+    {
+      pass++;
+      continue;
+    }
+
+    /* Counts become start offsets. */
+    offset = 0;
+    i = 0;
+    while (i < ROONIUM_SORT_BUCKETS)
+    {
+      count = counts[pass][i];
+      counts[pass][i] = offset;
+      offset += count;
+      i++;
+    }
+
+    i = 0;
+    while (i < _count)
+    {
+      destination[counts[pass][(source[i].key >> shift) & 0xff]++] =
+          source[i];
+      i++;
+    }
+
+    swap = source;
+    source = destination;
+    destination = swap;
+    pass++;
+  }
+
+  return source;
+}
+
+void roonium_sort__merge(
+    const struct roonium_sort_key *_a,
+    const size_t _a_count,
+    const struct roonium_sort_key *_b,
+    const size_t _b_count,
+    struct roonium_sort_key *_destination)
+{
+  size_t a = 0, b = 0;
+
+  while (a < _a_count && b < _b_count)
+  {
+    if (_b[b].key < _a[a].key)
+      *_destination++ = _b[b++];
+    else
+      *_destination++ = _a[a++];
+  }
+
+  memcpy(_destination, _a + a, (_a_count - a) * sizeof(*_a));
+  memcpy(
+      _destination + (_a_count - a),
+      _b + b,
+      (_b_count - b) * sizeof(*_b));
+}
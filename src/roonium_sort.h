@@ -0,0 +1,34 @@
+#ifndef ROONIUM_SORT_H
+#define ROONIUM_SORT_H
+
+#include <stddef.h>
+
+/* Sort entry: a 32 bit key and the index of what it stands for. */
+typedef struct roonium_sort_key
+{
+  unsigned int key;
+  unsigned int index;
+} roonium_sort_key;
+
+/* Key ordering floats like the floats themselves. Complement it for
+ * descending order. */
+unsigned int roonium_sort__float_key(
+    const float _value);
+
+/* Stable LSD radix sort of _count keys, 8 bits per pass. Passes where
+ * every key has the same byte are skipped. _scratch holds _count keys.
+ * Returns whichever of _keys and _scratch ends up sorted. */
+struct roonium_sort_key *roonium_sort__radix(
+    struct roonium_sort_key *_keys,
+    struct roonium_sort_key *_scratch,
+    const size_t _count);
+
+/* Stable merge of sorted _a and _b into _destination, _a first on
+ * equal keys. */
+void roonium_sort__merge(
+    const struct roonium_sort_key *_a,
+    const size_t _a_count,
+    const struct roonium_sort_key *_b,
+    const size_t _b_count,
+    struct roonium_sort_key *_destination);
+#endif
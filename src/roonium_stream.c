@@ -0,0 +1,196 @@
+#include <string.h>
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "roonium_stream.h"
+
+/* ARB_buffer_storage is not part of the GL 3.3 loader. */
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void(APIENTRYP roonium_buffer_storage_proc)(
+    GLenum _target,
+    GLsizeiptr _size,
+    const void *_data,
+    GLbitfield _flags);
+
+static roonium_buffer_storage_proc roonium_stream__get_buffer_storage(void)
+{
+  GLint major = 0, minor = 0;
+
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+
+  if ((major > 4 || (major == 4 && minor >= 4)) ||
+      glfwExtensionSupported("GL_ARB_buffer_storage"))
+  {
+    return (roonium_buffer_storage_proc)glfwGetProcAddress(
+        "glBufferStorage");
+  }
+
+  return NULL;
+}
+
+int roonium_stream__init(
+    struct roonium_stream *_stream,
+    const GLenum _target,
+    const size_t _capacity)
+{
+  const GLbitfield persistent_flags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  roonium_buffer_storage_proc buffer_storage;
+
+  memset(_stream, 0, sizeof(*_stream));
+  _stream->target = _target;
+  _stream->region_size = _capacity / ROONIUM_STREAM_FRAMES;
+  _stream->capacity = _stream->region_size * ROONIUM_STREAM_FRAMES;
+
+  glGenBuffers(1, &_stream->buffer);
+  glBindBuffer(_target, _stream->buffer);
+
+  buffer_storage = roonium_stream__get_buffer_storage();
+  if (buffer_storage)
+  {
+    buffer_storage(_target, _stream->capacity, NULL, persistent_flags);
+    _stream->persistent = glMapBufferRange(
+        _target,
+        0,
+        _stream->capacity,
+        persistent_flags);
+  }
+
+  /* Plain buffer, mapped per allocation. */
+  if (!_stream->persistent)
+  {
+    glBufferData(_target, _stream->capacity, NULL, GL_STREAM_DRAW);
+  }
+
+  glBindBuffer(_target, 0);
+
+  return glGetError() != GL_NO_ERROR;
+}
+
+void roonium_stream__begin_frame(
+    struct roonium_stream *_stream)
+{
+  GLsync fence;
+  GLenum status;
+
+  _stream->region = (_stream->region + 1) % ROONIUM_STREAM_FRAMES;
+  _stream->head = 0;
+
+  fence = _stream->fences[_stream->region];
+  if (!fence)
+    return;
+
+  status = glClientWaitSync(fence, 0, 0);
+  if (status == GL_TIMEOUT_EXPIRED)
+  {
+    _stream->stalls_count++;
+    do
+    {
+      status = glClientWaitSync(
+          fence,
+          GL_SYNC_FLUSH_COMMANDS_BIT,
+          1000000000);
+    } while (status == GL_TIMEOUT_EXPIRED);
+  }
+
+  glDeleteSync(fence);
+  _stream->fences[_stream->region] = 0;
+}
+
+void *roonium_stream__map(
+    struct roonium_stream *_stream,
+    const size_t _size,
+    const size_t _alignment,
+    size_t *_offset)
+{
+  const size_t base = _stream->region * _stream->region_size;
+  size_t offset = base + _stream->head;
+  void *result;
+
+  if (_alignment > 1)
+    offset = (offset + _alignment - 1) / _alignment * _alignment;
+
+  if (_stream->mapped ||
+      offset + _size > base + _stream->region_size)
+    return NULL;
+
+  if (_stream->persistent)
+  {
+    result = _stream->persistent + offset;
+  }
+  else
+  {
+    /* Fences already keep the GPU away from this region. */
+    glBindBuffer(_stream->target, _stream->buffer);
+    result = glMapBufferRange(
+        _stream->target,
+        offset,
+        _size,
+        GL_MAP_WRITE_BIT |
+            GL_MAP_UNSYNCHRONIZED_BIT |
+            GL_MAP_INVALIDATE_RANGE_BIT);
+    if (!result)
+      return NULL;
+    _stream->mapped = true;
+  }
+
+  _stream->head = offset + _size - base;
+  _stream->bytes_streamed += _size;
+  *_offset = offset;
+
+  return result;
+}
+
+void roonium_stream__unmap(
+    struct roonium_stream *_stream)
+{
+  if (!_stream->mapped)
+    return;
+
+  glBindBuffer(_stream->target, _stream->buffer);
+  glUnmapBuffer(_stream->target);
+  _stream->mapped = false;
+}
+
+void roonium_stream__end_frame(
+    struct roonium_stream *_stream)
+{
+  roonium_stream__unmap(_stream);
+
+  if (_stream->fences[_stream->region])
+    glDeleteSync(_stream->fences[_stream->region]);
+
+  _stream->fences[_stream->region] = glFenceSync(
+      GL_SYNC_GPU_COMMANDS_COMPLETE,
+      0);
+}
+
+void roonium_stream__free(
+    struct roonium_stream *_stream)
+{
+  size_t i = 0;
+
+  while (i < ROONIUM_STREAM_FRAMES)
+  {
+    if (_stream->fences[i])
+      glDeleteSync(_stream->fences[i]);
+    i++;
+  }
+
+  if (_stream->persistent)
+  {
+    glBindBuffer(_stream->target, _stream->buffer);
+    glUnmapBuffer(_stream->target);
+    glBindBuffer(_stream->target, 0);
+  }
+
+  glDeleteBuffers(1, &_stream->buffer);
+  memset(_stream, 0, sizeof(*_stream));
+}
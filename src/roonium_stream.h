@@ -0,0 +1,61 @@
+#ifndef ROONIUM_STREAM_H
+#define ROONIUM_STREAM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <glad/glad.h>
+
+/* Frames the GPU may still be reading while the CPU writes the next one. */
+#ifndef ROONIUM_STREAM_FRAMES
+#define ROONIUM_STREAM_FRAMES 3
+#endif
+
+/* Ring buffer for per-frame dynamic geometry.
+ * The buffer is split in ROONIUM_STREAM_FRAMES regions, one per frame in
+ * flight, each guarded by a fence. With ARB_buffer_storage the whole buffer
+ * stays persistently mapped, otherwise every allocation is mapped with
+ * unsynchronized + invalidate-range. */
+typedef struct roonium_stream
+{
+  GLuint buffer;
+  GLenum target;
+  size_t capacity;
+  size_t region_size;
+  size_t region;
+  size_t head;
+  unsigned char *persistent;
+  bool mapped;
+  GLsync fences[ROONIUM_STREAM_FRAMES];
+
+  /* Stats. */
+  size_t bytes_streamed;
+  size_t stalls_count;
+} roonium_stream;
+
+int roonium_stream__init(
+    struct roonium_stream *_stream,
+    const GLenum _target,
+    const size_t _capacity);
+
+/* Waits until the GPU is done with the region of this frame. */
+void roonium_stream__begin_frame(
+    struct roonium_stream *_stream);
+
+/* Returns memory to write _size bytes to, or NULL if the region is full.
+ * _offset receives the byte offset in the buffer, aligned to _alignment. */
+void *roonium_stream__map(
+    struct roonium_stream *_stream,
+    const size_t _size,
+    const size_t _alignment,
+    size_t *_offset);
+
+void roonium_stream__unmap(
+    struct roonium_stream *_stream);
+
+/* Fences the region written in this frame. */
+void roonium_stream__end_frame(
+    struct roonium_stream *_stream);
+
+void roonium_stream__free(
+    struct roonium_stream *_stream);
+#endif
@@ -0,0 +1,221 @@
+#include <string.h>
+#include <glad/glad.h>
+
+#include "roonium_textures.h"
+
+unsigned char *stbi_load_from_memory(unsigned char const *buffer, int len, int *x, int *y, int *channels_in_file, int desired_channels);
+
+#define ROONIUM_TEXTURES_ALIGN(_v)                                  \
+  (((_v) + ROONIUM_TEXTURES_PADDING - 1) / ROONIUM_TEXTURES_PADDING * \
+   ROONIUM_TEXTURES_PADDING)
+
+int roonium_textures__init(
+    struct roonium_textures *_textures)
+{
+  memset(_textures, 0, sizeof(*_textures));
+
+  glGenTextures(1, &_textures->id);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, _textures->id);
+  glTexImage3D(
+      GL_TEXTURE_2D_ARRAY,
+      0,
+      GL_RGBA8,
+      ROONIUM_TEXTURES_SIZE,
+      ROONIUM_TEXTURES_SIZE,
+      ROONIUM_TEXTURES_LAYERS,
+      0,
+      GL_RGBA,
+      GL_UNSIGNED_BYTE,
+      NULL);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, ROONIUM_TEXTURES_LEVELS - 1);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  return glGetError() != GL_NO_ERROR;
+}
+
+/* Best fitting shelf with room, or a new one under the last.
+ * Returns 0 and the layer and corner on success. */
+static int roonium_textures__place(
+    struct roonium_textures *_textures,
+    const unsigned int _width,
+    const unsigned int _height,
+    unsigned int *_layer,
+    unsigned int *_x,
+    unsigned int *_y)
+{
+  struct roonium_texture_shelf *shelf, *best;
+  unsigned int layer = 0, top;
+  size_t i;
+
+  while (layer < ROONIUM_TEXTURES_LAYERS)
+  {
+    best = NULL;
+    i = 0;
+    while (i < _textures->shelves_count[layer])
+    {
+      shelf = &_textures->shelves[layer][i];
+      if (shelf->height >= _height &&
+          shelf->width_used + _width <= ROONIUM_TEXTURES_SIZE &&
+          (!best || shelf->height < best->height))
+        best = shelf;
+      i++;
+    }
+
+    if (!best && _textures->shelves_count[layer] < ROONIUM_TEXTURES_SHELVES_MAX)
+    {
+      top = 0;
+      if (_textures->shelves_count[layer])
+      {
+        shelf = &_textures->shelves[layer][_textures->shelves_count[layer] - 1];
+        top = shelf->y + shelf->height;
+      }
+      if (top + _height <= ROONIUM_TEXTURES_SIZE)
+      {
+        best = &_textures->shelves[layer][_textures->shelves_count[layer]++];
+        best->y = top;
+        best->height = _height;
+        best->width_used = 0;
+      }
+    }
+
+    if (best)
+    {
+      *_layer = layer;
+      *_x = best->width_used;
+      *_y = best->y;
+      best->width_used += _width;
+      return 0;
+    }
+    layer++;
+  }
+
+  return 1;
+}
+
+unsigned int roonium_textures__add(
+    struct roonium_textures *_textures,
+    struct roonium_arena *_scratch,
+    const unsigned char *_pixels,
+    const size_t _width,
+    const size_t _height)
+{
+  const unsigned int width =
+      ROONIUM_TEXTURES_ALIGN((unsigned int)_width + 2 * ROONIUM_TEXTURES_PADDING);
+  const unsigned int height =
+      ROONIUM_TEXTURES_ALIGN((unsigned int)_height + 2 * ROONIUM_TEXTURES_PADDING);
+  struct roonium_texture_region *region;
+  unsigned char *padded;
+  unsigned int layer, x, y, source_x, source_y;
+
+  if (_textures->regions_count >= ROONIUM_TEXTURES_MAX ||
+      !_width || !_height ||
+      width > ROONIUM_TEXTURES_SIZE || height > ROONIUM_TEXTURES_SIZE ||
+      roonium_textures__place(_textures, width, height, &layer, &x, &y))
+    return ROONIUM_TEXTURE_INVALID;
+
+  padded = roonium_arena__alloc(_scratch, (size_t)width * height * 4);
+  if (!padded)
+    return ROONIUM_TEXTURE_INVALID;
+
+  /* Edges repeated outwards, so filtering never reaches a neighbour. */
+  source_y = 0;
+  while (source_y < height)
+  {
+    const unsigned int row =
+        source_y < ROONIUM_TEXTURES_PADDING
+            ? 0
+            : (source_y - ROONIUM_TEXTURES_PADDING >= _height
+                   ? (unsigned int)_height - 1
+                   : source_y - ROONIUM_TEXTURES_PADDING);
+    source_x = 0;
+    while (source_x < width)
+    {
+      const unsigned int column =
+          source_x < ROONIUM_TEXTURES_PADDING
+              ? 0
+              : (source_x - ROONIUM_TEXTURES_PADDING >= _width
+                     ? (unsigned int)_width - 1
+                     : source_x - ROONIUM_TEXTURES_PADDING);
+      memcpy(
+          padded + ((size_t)source_y * width + source_x) * 4,
+          _pixels + ((size_t)row * _width + column) * 4,
+          4);
+      source_x++;
+    }
+    source_y++;
+  }
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, _textures->id);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexSubImage3D(
+      GL_TEXTURE_2D_ARRAY,
+      0,
+      x,
+      y,
+      layer,
+      width,
+      height,
+      1,
+      GL_RGBA,
+      GL_UNSIGNED_BYTE,
+      padded);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+  region = &_textures->regions[_textures->regions_count];
+  region->rect[0] = (float)(x + ROONIUM_TEXTURES_PADDING) / ROONIUM_TEXTURES_SIZE;
+  region->rect[1] = (float)(y + ROONIUM_TEXTURES_PADDING) / ROONIUM_TEXTURES_SIZE;
+  region->rect[2] = (float)_width / ROONIUM_TEXTURES_SIZE;
+  region->rect[3] = (float)_height / ROONIUM_TEXTURES_SIZE;
+  region->layer = (float)layer;
+
+  return (unsigned int)_textures->regions_count++;
+}
+
+unsigned int roonium_textures__load_from_memory(
+    struct roonium_textures *_textures,
+    struct roonium_arena *_scratch,
+    const unsigned char *_data,
+    const size_t _size)
+{
+  unsigned int handle;
+  unsigned char *pixels;
+  int w, h;
+
+  pixels = stbi_load_from_memory(_data, (int)_size, &w, &h, 0, 4);
+  if (!pixels)
+    return ROONIUM_TEXTURE_INVALID;
+
+  handle = roonium_textures__add(_textures, _scratch, pixels, w, h);
+  roonium_memory__free(pixels);
+
+  return handle;
+}
+
+void roonium_textures__generate_mipmaps(
+    struct roonium_textures *_textures)
+{
+  glBindTexture(GL_TEXTURE_2D_ARRAY, _textures->id);
+  glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+const struct roonium_texture_region *roonium_textures__get(
+    const struct roonium_textures *_textures,
+    const unsigned int _handle)
+{
+  if (_handle >= _textures->regions_count)
+    return &_textures->regions[0];
+
+  return &_textures->regions[_handle];
+}
+
+void roonium_textures__free(
+    struct roonium_textures *_textures)
+{
+  glDeleteTextures(1, &_textures->id);
+  memset(_textures, 0, sizeof(*_textures));
+}
@@ -0,0 +1,93 @@
+#ifndef ROONIUM_TEXTURES_H
+#define ROONIUM_TEXTURES_H
+
+#include <stddef.h>
+#include <glad/glad.h>
+
+#include "roonium_memory.h"
+
+/* Width and height of every layer. */
+#ifndef ROONIUM_TEXTURES_SIZE
+#define ROONIUM_TEXTURES_SIZE 1024
+#endif
+
+#ifndef ROONIUM_TEXTURES_LAYERS
+#define ROONIUM_TEXTURES_LAYERS 4
+#endif
+
+/* Texels of repeated edge around every image. Rectangles are aligned to
+ * it too, so mip levels up to log2 of it never mix two images. */
+#ifndef ROONIUM_TEXTURES_PADDING
+#define ROONIUM_TEXTURES_PADDING 8
+#endif
+#define ROONIUM_TEXTURES_LEVELS 4
+
+#ifndef ROONIUM_TEXTURES_MAX
+#define ROONIUM_TEXTURES_MAX 64
+#endif
+
+#ifndef ROONIUM_TEXTURES_SHELVES_MAX
+#define ROONIUM_TEXTURES_SHELVES_MAX 32
+#endif
+
+#define ROONIUM_TEXTURE_INVALID ((unsigned int)-1)
+
+/* Where an image ended up. rect is u, v, width and height in [0, 1]. */
+typedef struct roonium_texture_region
+{
+  float rect[4];
+  float layer;
+} roonium_texture_region;
+
+/* Row of images in a layer, as tall as its first image. */
+typedef struct roonium_texture_shelf
+{
+  unsigned int y;
+  unsigned int height;
+  unsigned int width_used;
+} roonium_texture_shelf;
+
+/* Images packed into the layers of one GL_TEXTURE_2D_ARRAY, so draws
+ * with different images share a bind. */
+typedef struct roonium_textures
+{
+  GLuint id;
+  struct roonium_texture_region regions[ROONIUM_TEXTURES_MAX];
+  size_t regions_count;
+  struct roonium_texture_shelf
+      shelves[ROONIUM_TEXTURES_LAYERS][ROONIUM_TEXTURES_SHELVES_MAX];
+  size_t shelves_count[ROONIUM_TEXTURES_LAYERS];
+} roonium_textures;
+
+/* Returns 0 on success. */
+int roonium_textures__init(
+    struct roonium_textures *_textures);
+
+/* Packs _width x _height RGBA pixels. The padded copy is built in
+ * _scratch. Returns a handle or ROONIUM_TEXTURE_INVALID. */
+unsigned int roonium_textures__add(
+    struct roonium_textures *_textures,
+    struct roonium_arena *_scratch,
+    const unsigned char *_pixels,
+    const size_t _width,
+    const size_t _height);
+
+/* Decodes an image with stb_image, then adds it. */
+unsigned int roonium_textures__load_from_memory(
+    struct roonium_textures *_textures,
+    struct roonium_arena *_scratch,
+    const unsigned char *_data,
+    const size_t _size);
+
+/* Rebuilds the mip levels after images were added. */
+void roonium_textures__generate_mipmaps(
+    struct roonium_textures *_textures);
+
+/* Region of _handle; an invalid handle gets the first region. */
+const struct roonium_texture_region *roonium_textures__get(
+    const struct roonium_textures *_textures,
+    const unsigned int _handle);
+
+void roonium_textures__free(
+    struct roonium_textures *_textures);
+#endif